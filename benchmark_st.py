@@ -43,7 +43,7 @@ def dc():
             * it sets the total number of queries as total args in the graph or user input (argv[3]) (if total < input, then total, else input)
             * it applies the transformation to D-DNNF by calling utils/operations.py (which will use executables/d4) and it records the time taken in the csv
             * it verifies if the D-DNNF transformation was UNSAT (by checking if the file containing the representation is empty) and it records it in the csv
-            * it executes the D-DNNF queries by calling utils/operations.py (which will use executables/query-dnnf) and it records the time taken in the csv
+            * it executes the D-DNNF queries by calling utils/operations.py (which will use executables/query-dnnf, or query-ddnnf if operations.query is given reasoner="query-ddnnf") and it records the time taken in the csv
             * it executes the CNF queries by calling utils/operations (which will use executables/[...]/mu-toksia), the time is recorded from inside mu-toksia
 
     The outputs of each executables are muted using > /dev/null 2>&1, get rid of this if you want to be able to debug each executable.
@@ -117,7 +117,7 @@ def ds():
             * it sets the total number of queries as total args in the graph or user input (argv[3]) (if total < input, then total, else input)
             * it applies the transformation to D-DNNF by calling utils/operations.py (which will use executables/d4) and it records the time taken in the csv
             * it verifies if the D-DNNF transformation was UNSAT (by checking if the file containing the representation is empty) and it records it in the csv
-            * it executes the D-DNNF queries by calling utils/operations.py (which will use executables/query-dnnf) and it records the time taken in the csv
+            * it executes the D-DNNF queries by calling utils/operations.py (which will use executables/query-dnnf, or query-ddnnf if operations.query is given reasoner="query-ddnnf") and it records the time taken in the csv
             * it executes the CNF queries by calling utils/operations (which will use executables/[...]/mu-toksia), the time is recorded from inside mu-toksia
 
     The outputs of each executables are muted using > /dev/null 2>&1, get rid of this if you want to be able to debug each executable.
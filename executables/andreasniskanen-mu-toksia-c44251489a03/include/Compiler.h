@@ -0,0 +1,216 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define COMPILER_CACHE_BYTES (1ULL << 31)
+#define COMPILER_CACHE_SHARDS 64
+#define COMPILER_NODE_CHUNK_BITS 16
+#define COMPILER_NODE_SHARDS 64
+#define COMPILER_NODE_SHARD_SLOTS (1 << 10)
+#define COMPILER_MIN_TASK_VARS 8
+
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include "Encodings.h"
+#include "DDNNF.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+/*
+ * Top-down compiler from CNF to decision-DNNF. Exhaustive DPLL branches on
+ * the most frequent variable of the current component, unit propagates on
+ * the trail of a SAT solver holding the clauses, and splits the residual
+ * formula into variable-disjoint components that are compiled independently
+ * and joined under an AND node. The node of each component is cached by its
+ * variables and unsatisfied clauses, which determine its residual formula.
+ * Since the search does not learn clauses, a second solver checks each
+ * branch for a model before it is split, so that every component compiled is
+ * satisfiable and unsatisfiable subtrees are never enumerated.
+ *
+ * Each thread owns a pair of solvers and a deque of tasks, which are the
+ * components and the second branches it leaves for idle threads to steal. A
+ * task carries the decisions leading to it, and a thread replays them on its
+ * solvers before running it. Threads share the component cache, split into
+ * shards under their own locks and evicted in insertion order beyond
+ * COMPILER_CACHE_BYTES, and the node store, whose nodes are appended to
+ * chunks through an atomic counter and hash-consed in an open-addressing index
+ * split into shards under their own locks, each doubled when half full, so
+ * equal nodes are always stored once. A thread without tasks sleeps until one
+ * is spawned or the task it waits for is done.
+ *
+ * Given ranks for the variables, branching prefers the lowest rank present in
+ * a component. Ranked by the SCCs of an AF in topological order, the upstream
+ * SCCs are decided first, after which each downstream SCC is a component of
+ * its own, conditioned on its boundary. Components are then also cached by
+ * shape, their residual clauses over the positions of their variables, and
+ * a component of the same shape as a compiled one copies its circuit with the
+ * variables renamed, so repeated substructures are searched only once.
+ *
+ * Attacks marked dynamic are compiled with a selector variable each, as in
+ * the encoding of the dynamic mode, so a what-if update adding or deleting
+ * one is a conditioning of the same circuit. The subcircuits that do not
+ * depend on a selector are shared by all of its values.
+ */
+class Compiler {
+
+public:
+	// the circuit is over at least n_vars variables, the ones beyond the clauses being free
+	Compiler(const std::vector<std::vector<int32_t>> & clauses, uint32_t n_threads, uint32_t n_vars = 0);
+	~Compiler();
+	void compile(DDNNF & out);
+	void set_ranks(const std::vector<uint32_t> & var_rank);
+	// compiles the encoding of af.sem, if it is one given by a CNF, ranking the
+	// variables of each argument by its SCC if by_scc is set; the attack k of
+	// dynamic_attacks, given by argument indices, is present iff variable
+	// af.args+k+1 is true, so changes to it are made by conditioning
+	static bool compile(const DynamicAF & af, DDNNF & out, uint32_t n_threads = 1, bool by_scc = false,
+		const std::vector<std::pair<int32_t,int32_t>> & dynamic_attacks = std::vector<std::pair<int32_t,int32_t>>());
+
+private:
+	struct Component {
+		std::vector<uint32_t> vars;
+		std::vector<uint32_t> clauses;
+	};
+
+	struct KeyHash {
+		size_t operator()(const std::vector<uint32_t> & key) const
+		{
+			size_t seed = key.size();
+			for (uint32_t i = 0; i < key.size(); i++) hash_combine(seed, key[i]);
+			return seed;
+		}
+	};
+
+	// the node of a component, and for a shape the variables it was compiled over
+	struct CacheEntry {
+		uint32_t node;
+		std::vector<uint32_t> vars;
+	};
+
+	struct CacheShard {
+		std::mutex mutex;
+		std::unordered_map<std::vector<uint32_t>, CacheEntry, KeyHash> entries;
+		std::deque<const std::vector<uint32_t> *> order;
+		uint64_t bytes = 0;
+	};
+
+	struct StoredNode {
+		DDNNF::node_type type;
+		int32_t literal;
+		std::vector<uint32_t> children;
+	};
+
+	// the hash and node+1 of each slot, 0 if the slot is free
+	struct NodeShard {
+		std::mutex mutex;
+		std::vector<std::pair<size_t, uint32_t>> slots;
+		uint32_t used = 0;
+	};
+
+	struct Task {
+		Component component;
+		std::vector<int32_t> decisions;
+		// the literal of a branch of the component, or 0 to compile the whole component
+		int32_t lit;
+		uint32_t result;
+		std::atomic<bool> done;
+	};
+
+	struct Worker {
+		uint32_t index;
+		SAT_Solver * solver;
+		SAT_Solver * oracle;
+		// the path of the current task, and the decisions pushed on solver, which
+		// differ from it between running a stolen task and resuming the own one
+		std::vector<int32_t> decisions;
+		std::vector<int32_t> pushed;
+		// the last model of the oracle
+		std::vector<uint8_t> model;
+		std::mutex mutex;
+		std::deque<Task *> tasks;
+		// marks for the current call to components, and branching scores
+		uint32_t stamp;
+		std::vector<uint32_t> var_in, var_seen, clause_in, clause_seen;
+		std::vector<uint32_t> score;
+		// the position of each variable in the component whose shape is built
+		std::vector<uint32_t> local;
+	};
+
+	const std::vector<std::vector<int32_t>> & clauses;
+	uint32_t vars;
+	uint32_t false_node;
+	uint32_t true_node;
+	bool root_conflict;
+	// the clauses of each variable
+	std::vector<std::vector<uint32_t>> occurrences;
+	// branching ranks, and whether components are cached by shape
+	std::vector<uint32_t> rank;
+	bool by_shape;
+	std::vector<Worker *> workers;
+	std::atomic<uint32_t> idle;
+	std::atomic<bool> finished;
+	// the number of tasks in the deques, and the wakeup of the threads waiting for one
+	std::atomic<uint32_t> pending;
+	std::mutex sleep_mutex;
+	std::condition_variable wakeup;
+
+	CacheShard cache[COMPILER_CACHE_SHARDS];
+	CacheShard shape_cache[COMPILER_CACHE_SHARDS];
+	std::vector<std::atomic<StoredNode *>> node_chunks;
+	std::atomic<uint32_t> node_count;
+	NodeShard node_index[COMPILER_NODE_SHARDS];
+
+	bool cache_lookup(CacheShard * shards, const std::vector<uint32_t> & key, CacheEntry & entry);
+	void cache_insert(CacheShard * shards, const std::vector<uint32_t> & key, const CacheEntry & entry);
+	StoredNode & stored(uint32_t node);
+	uint32_t append_node(DDNNF::node_type type, int32_t literal, const std::vector<uint32_t> & node_children);
+	uint32_t make_node(DDNNF::node_type type, int32_t literal, std::vector<uint32_t> & node_children);
+
+	bool satisfied(Worker & w, uint32_t c);
+	bool consistent(Worker & w);
+	void sync(Worker & w);
+	Task * spawn(Worker & w, const Component & component, int32_t lit);
+	Task * take(Worker & w);
+	void wake(bool all);
+	void run(Worker & w, Task * task);
+	void wait(Worker & w, Task * task);
+	void work(Worker & w);
+	void components(Worker & w, const std::vector<uint32_t> & component_vars, const std::vector<uint32_t> & component_clauses, std::vector<Component> & out);
+	uint32_t conjoin(Worker & w, uint32_t trail_begin, std::vector<Component> & parts);
+	uint32_t branch(Worker & w, const Component & component, int32_t lit);
+	void shape(Worker & w, const Component & component, std::vector<uint32_t> & key);
+	uint32_t instantiate(uint32_t node, std::unordered_map<uint32_t, uint32_t> & rename, std::unordered_map<uint32_t, uint32_t> & copies);
+	uint32_t compile(Worker & w, const Component & component);
+
+};
+
+#endif
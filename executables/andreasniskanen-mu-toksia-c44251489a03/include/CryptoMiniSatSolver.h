@@ -30,6 +30,9 @@
 #define CMSAT_SOLVER_H
 
 #include "SATSolver.h"
+
+#include <atomic>
+#include <chrono>
 #if defined(SAT_CMSAT)
 #include <cryptominisat.h>
 #endif
@@ -39,7 +42,31 @@ class CryptoMiniSatSolver : public SATSolver {
 private:
 	CMSat::SATSolver solver;
 	std::vector<CMSat::Lit> assumptions;
+	// the last model returned by solve, kept apart from the models rejected by refine
+	std::vector<CMSat::lbool> model;
 	int32_t decision_vars;
+	int64_t conflict_limit;
+	int64_t propagation_limit;
+	bool timed;
+	std::chrono::steady_clock::time_point deadline;
+	std::atomic<bool> interrupted;
+	// levels pushed, and the literals they assign in order
+	std::vector<CMSat::Lit> pushed;
+	std::vector<CMSat::Lit> trail;
+	std::vector<uint32_t> trail_lim;
+	std::vector<int8_t> values;
+	// the clauses for push, watched by their first two literals, and the unit clauses
+	std::vector<std::vector<CMSat::Lit>> clauses;
+	std::vector<std::vector<uint32_t>> watches;
+	std::vector<CMSat::Lit> units;
+	uint32_t qhead;
+	bool stale;
+	bool assign(CMSat::Lit lit);
+	int8_t lit_value(CMSat::Lit lit);
+	void attach(std::vector<CMSat::Lit> & lits);
+	bool propagate_trail();
+	bool repropagate();
+	bool exhausted();
 
 public:
 	CryptoMiniSatSolver(int32_t n_vars, int32_t n_args);
@@ -49,7 +76,20 @@ public:
 	bool solve();
 	bool propagate(std::vector<int32_t> & out_lits);
 	bool get_value(int32_t lit);
+	void simplify();
+	void set_phase(int32_t lit);
+	void set_activity(int32_t var, double activity);
+	void set_limits(int64_t conflicts, int64_t propagations, double seconds);
+	void interrupt();
+	bool push(int32_t lit);
+	void pop();
+	int8_t value(int32_t lit);
+	uint32_t trail_size();
+	int32_t trail_lit(uint32_t i);
+	uint64_t reserved_bytes();
+	bool huge_pages();
 	std::vector<uint8_t> assignment;
+	std::vector<int32_t> core;
 
 };
 
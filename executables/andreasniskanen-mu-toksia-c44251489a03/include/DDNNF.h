@@ -0,0 +1,182 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define DDNNF_MAGIC "DDNNFBIN"
+#define DDNNF_FORMAT_VERSION 1
+
+#ifndef DDNNF_H
+#define DDNNF_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <random>
+
+/*
+ * Deterministic decomposable NNF circuit read from the c2d/NNF format that
+ * d4 emits, or from the binary format written by save. Nodes are kept in
+ * file order, so that the children of a node always precede it and the root
+ * is the last node, in one flat array of fixed-size records. The children of
+ * node i are stored in decreasing order as varint-coded gaps, starting from
+ * i, in bytes nodes[i].begin .. nodes[i+1].begin of one child array, and
+ * the leaves of each literal are indexed. The binary format is these arrays
+ * as they are in memory, so it is mapped instead of parsed, after one pass
+ * that checks its structure.
+ */
+class DDNNF {
+
+public:
+	enum node_type : uint8_t { LITERAL, AND, OR };
+
+	struct Node {
+		uint64_t begin;
+		// the literal of a leaf, or the decision variable of an OR node (0 if unknown)
+		int32_t literal;
+		node_type type;
+	};
+
+	struct Children {
+		const uint8_t * p;
+		const uint8_t * end;
+		uint32_t last;
+
+		bool next(uint32_t & child)
+		{
+			if (p == end) return false;
+			uint32_t gap = 0;
+			for (uint32_t shift = 0; ; shift += 7) {
+				gap |= (uint32_t)(*p & 127) << shift;
+				if (!(*p++ & 128)) break;
+			}
+			child = last -= gap;
+			return true;
+		}
+	};
+
+	DDNNF();
+	~DDNNF();
+	DDNNF(const DDNNF &) = delete;
+	DDNNF & operator=(const DDNNF &) = delete;
+	bool load(const std::string & path);
+	bool save(const std::string & path) const;
+	// builds a circuit bottom-up, adding each node after its children; the last node is the root
+	void clear(uint32_t n_vars);
+	uint32_t add_node(node_type type, int32_t literal, std::vector<uint32_t> & node_children);
+	void finish();
+
+	uint32_t vars;
+
+	uint32_t size() const { return n_nodes-1; }
+	uint32_t root() const { return n_nodes-2; }
+	const Node & node(uint32_t i) const { return nodes[i]; }
+	Children children(uint32_t i) const { return { child_data + nodes[i].begin, child_data + nodes[i+1].begin, i }; }
+	// the leaves with literal lit are leaves(lit)[0 .. n_leaves(lit))
+	const uint32_t * leaves(int32_t lit) const { return literal_leaves + literal_begin[literal_index(lit)]; }
+	uint32_t n_leaves(int32_t lit) const { return literal_begin[literal_index(lit)+1] - literal_begin[literal_index(lit)]; }
+
+	bool satisfiable(const std::vector<int32_t> & lits);
+	bool model(const std::vector<int32_t> & lits, std::vector<int32_t> & out_model);
+	std::string count(const std::vector<int32_t> & lits);
+	// for every variable at once, whether the circuit stays satisfiable with it set true and false,
+	// in one pass over the circuit and one over the ancestors of each block of 64 undecided variables
+	void satisfiable_literals(const std::vector<int32_t> & lits, std::vector<uint8_t> & positive, std::vector<uint8_t> & negative);
+	// weights are indexed by literal_index and default to 1; the weighted count is the sum over
+	// the models of the products of the weights of their literals, returned as its natural
+	// logarithm, and -INFINITY if it is zero
+	double log_weighted_count(const std::vector<int32_t> & lits, const std::vector<double> & weights);
+	// also the probability of each variable being true in a model drawn by weight, from one
+	// bottom-up and one top-down pass
+	double probabilities(const std::vector<int32_t> & lits, const std::vector<double> & weights, std::vector<double> & out_probability);
+
+	// models drawn uniformly at random, with the free variables of each drawn as fair coins
+	bool sample(const std::vector<int32_t> & lits, uint32_t n_samples, std::mt19937 & rng, std::vector<std::vector<int32_t>> & out_models);
+	// every model with the literals set true, one per call to next_model until it returns false;
+	// the proof trees are enumerated in lexicographic order of their choices at OR nodes and the
+	// variables free in each are counted through, in memory linear in the circuit, and the delay
+	// is linear in the model given, as a new proof tree is only traversed once per implicant
+	bool start_enumeration(const std::vector<int32_t> & lits);
+	bool next_model(std::vector<int32_t> & out_model);
+
+	static uint32_t literal_index(int32_t lit) { return 2*(lit > 0 ? lit : -lit) + (lit < 0); }
+
+private:
+	uint32_t n_nodes;
+	const Node * nodes;
+	const uint8_t * child_data;
+	const uint64_t * literal_begin;
+	const uint32_t * literal_leaves;
+
+	// arrays of a circuit read from text; a binary one is mapped instead
+	std::vector<Node> node_storage;
+	std::vector<uint8_t> child_storage;
+	std::vector<uint64_t> literal_begin_storage;
+	std::vector<uint32_t> literal_leaf_storage;
+	void * mapping;
+	size_t mapping_size;
+
+	// value of each literal under the conditioning: 1 assumed, -1 contradicted, 0 free
+	std::vector<int8_t> assigned;
+	// satisfiability of each node: 1 yes, 2 no, 0 not visited by the last query
+	std::vector<uint8_t> sat;
+	std::vector<uint32_t> visited;
+	bool evaluated;
+	std::vector<uint8_t> reach;
+
+	// state of an enumeration: the satisfiable nodes and the conditioning it started with, the
+	// chosen child position of each OR node, the OR nodes of the last proof tree in the order
+	// they were reached, the variables left free by it, and the current model
+	bool enumerating;
+	bool first_tree;
+	std::vector<uint8_t> live;
+	std::vector<int8_t> fixed;
+	std::vector<uint32_t> choice;
+	std::vector<uint32_t> kept;
+	uint32_t stamp;
+	std::vector<uint32_t> decisions;
+	std::vector<uint32_t> free_vars;
+	std::vector<int8_t> enum_values;
+	std::vector<uint32_t> enum_stack;
+
+	bool parse(const std::string & path);
+	bool map(const std::string & path);
+	bool validate(uint64_t child_bytes, uint64_t n_leaf_entries) const;
+	void unmap();
+	void attach();
+	void index_literals();
+	void clear_sat();
+	void evaluate();
+	bool condition(const std::vector<int32_t> & lits);
+	void uncondition(const std::vector<int32_t> & lits);
+	int8_t value(int32_t lit) const;
+	void count_nodes(std::vector<std::vector<uint32_t>> & counts);
+	bool next_child(uint32_t i, uint32_t & position, uint32_t & out_child);
+	long double log_weights(const std::vector<double> & weights, std::vector<long double> & probability, std::vector<long double> & log_value);
+
+};
+
+#endif
@@ -27,6 +27,8 @@
  */
 
 #define MAX_DYNAMIC_ARGS 1024
+#define DENSE_MIN_DENSITY 0.25
+#define DENSE_BLOCK_SIZE 8
 
 #ifndef DYNAMIC_AF_H
 #define DYNAMIC_AF_H
@@ -96,10 +98,14 @@ DynamicAF();
 sigma sem;
 bool static_mode;
 bool vars_initialized;
+bool dense;
+bool lazy;
 
 uint32_t args;
 uint32_t args_remaining;
 uint32_t count;
+uint32_t group_base;
+uint64_t version;
 
 std::vector<int32_t> int_to_arg;
 std::unordered_map<int32_t,int32_t> arg_to_int;
@@ -110,12 +116,18 @@ std::vector<uint8_t> arg_exists;
 std::unordered_set<std::pair<int32_t,int32_t>> attacks;
 std::unordered_set<std::pair<int32_t,int32_t>> symmetric_attacks;
 
+// shared attacker groups of the dense encoding, and the attackers of each argument outside them
+std::vector<std::vector<int32_t>> groups;
+std::vector<std::vector<int32_t>> attacker_groups;
+std::vector<std::vector<int32_t>> ungrouped_attackers;
+
 bool add_argument(int32_t a);
 bool add_attack(int32_t s, int32_t t);
 bool del_argument(int32_t a);
 bool del_attack(int32_t s, int32_t t);
 void add_dummy_args(int32_t n_args);
 void initialize_attackers();
+void initialize_groups();
 void set_var_count();
 
 int accepted_var(int32_t a) const;
@@ -125,6 +137,8 @@ int arg_exists_var(int32_t a) const;
 int att_exists_var(int32_t s, int32_t t) const;
 int source_accepted_var(int32_t s, int32_t t) const;
 int source_rejected_var(int32_t s, int32_t t) const;
+int group_accepted_var(int32_t g) const;
+int group_rejected_var(int32_t g) const;
 
 };
 
@@ -135,5 +149,7 @@ inline int DynamicAF::arg_exists_var(int32_t a) const { return 3*args + a+1; }
 inline int DynamicAF::att_exists_var(int32_t s, int32_t t)      const { return 4*args + args*s + t+1; }
 inline int DynamicAF::source_accepted_var(int32_t s, int32_t t) const { return 4*args + args*args + args*s + t+1; }
 inline int DynamicAF::source_rejected_var(int32_t s, int32_t t) const { return 4*args + 2*args*args + args*s + t+1; }
+inline int DynamicAF::group_accepted_var(int32_t g) const { return group_base + 2*g+1; }
+inline int DynamicAF::group_rejected_var(int32_t g) const { return group_base + 2*g+2; }
 
 #endif
@@ -48,7 +48,8 @@ void add_admissible(const DynamicAF & af, SAT_Solver * solver);
 void add_complete(const DynamicAF & af, SAT_Solver * solver);
 void add_stable(const DynamicAF & af, SAT_Solver * solver);
 void add_range(const DynamicAF & af, SAT_Solver * solver);
-int32_t add_target(DynamicAF & af, const std::vector<int32_t> & assumptions, SAT_Solver * solver);
+bool refine(const DynamicAF & af, SAT_Solver * solver);
+int32_t add_target(DynamicAF & af, const std::vector<int32_t> & assumptions, bool cred, SAT_Solver * solver);
 
 }
 
@@ -30,6 +30,8 @@
 #define GLUCOSE_SOLVER_H
 
 #include "SATSolver.h"
+
+#include <chrono>
 #if defined(SAT_GLUCOSE)
 #include <core/Solver.h>
 #endif
@@ -40,6 +42,12 @@ private:
 	Glucose::Solver * solver;
 	Glucose::vec<Glucose::Lit> assumptions;
 	int32_t decision_vars;
+	int64_t conflict_limit;
+	int64_t propagation_limit;
+	bool timed;
+	std::chrono::steady_clock::time_point deadline;
+	bool exhausted();
+	bool attach_above_root(Glucose::vec<Glucose::Lit> & lits);
 
 public:
 	GlucoseSolver(int32_t n_vars, int32_t n_args);
@@ -49,7 +57,23 @@ public:
 	bool solve();
 	bool propagate(std::vector<int32_t> & out_lits);
 	bool get_value(int32_t lit);
+	void simplify();
+	void set_phase(int32_t lit);
+	void set_activity(int32_t var, double activity);
+	void set_limits(int64_t conflicts, int64_t propagations, double seconds);
+	void interrupt();
+	bool push(int32_t lit);
+	void pop();
+	int8_t value(int32_t lit);
+	uint32_t trail_size();
+	int32_t trail_lit(uint32_t i);
+	uint64_t reserved_bytes();
+	bool huge_pages();
+	int32_t binary_watches();
+	int32_t arena_binary_watches();
+	int32_t arena_binaries();
 	std::vector<uint8_t> assignment;
+	std::vector<int32_t> core;
 
 };
 
@@ -0,0 +1,48 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include "DynamicAF.h"
+
+namespace LocalSearch {
+
+/*
+ * WalkSAT-style search for a stable extension that satisfies the given
+ * accepted/rejected literals, flipping arguments in and out of the extension
+ * and tracking for each argument the number of its attackers that are in.
+ * Requires af.attackers to be initialized. On return, labelling holds the
+ * accepted and rejected values (indexed by variable-1) of the extension found,
+ * or of the labelling with the fewest violations if max_flips ran out.
+ */
+bool stable(const DynamicAF & af, const std::vector<int32_t> & lits, uint64_t max_flips, std::vector<uint8_t> & labelling);
+
+}
+
+#endif
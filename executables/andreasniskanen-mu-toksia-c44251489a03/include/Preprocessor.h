@@ -0,0 +1,85 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define PREPROCESS_ROUNDS 3
+#define PREPROCESS_STEPS 100000000
+
+#ifndef PREPROCESSOR_H
+#define PREPROCESSOR_H
+
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+/*
+ * Simplification of a CNF that preserves its projection on the frozen
+ * variables 1..n_frozen, the acceptance of the arguments, and so the number
+ * of extensions counted over them. Top-level units are propagated,
+ * equivalent literals are substituted by one representative, preferring a
+ * frozen one, clauses are subsumed and strengthened by self-subsuming
+ * resolution, and other variables are eliminated by resolution while that
+ * does not add clauses. The variables left are renumbered after the frozen
+ * ones, which keep their numbers.
+ */
+class Preprocessor {
+
+public:
+	Preprocessor(std::vector<std::vector<int32_t>> & clauses, uint32_t n_frozen);
+	// simplifies the clauses in place, and returns the number of variables left
+	uint32_t simplify();
+	// the variable each original one is renumbered to, 0 if it is eliminated
+	std::vector<uint32_t> renamed;
+
+private:
+	std::vector<std::vector<int32_t>> & clauses;
+	uint32_t frozen;
+	uint32_t vars;
+	bool unsat;
+	uint64_t steps;
+	std::vector<uint8_t> removed;
+	// the clauses of each literal 2*var+(lit < 0), which may also hold clauses
+	// that were removed or strengthened since
+	std::vector<std::vector<uint32_t>> occurs;
+	std::vector<int8_t> value;
+	std::vector<uint8_t> eliminated;
+	std::vector<int32_t> units;
+
+	uint32_t index(int32_t lit) const { return 2*abs(lit) + (lit < 0); }
+	bool contains(uint32_t c, int32_t lit) const;
+	void add(std::vector<int32_t> & clause);
+	void strengthen(uint32_t c, int32_t lit);
+	bool propagate();
+	bool substitute();
+	void subsume();
+	bool resolve(const std::vector<int32_t> & pos, const std::vector<int32_t> & neg, int32_t lit, std::vector<int32_t> & out);
+	bool eliminate(uint32_t var);
+	void renumber();
+
+};
+
+#endif
@@ -31,18 +31,45 @@
 
 #include <vector>
 #include <cstdint>
+#include <functional>
+
+// conflicts per call to the backend while a wall-clock or propagation limit is checked
+#define SOLVE_SLICE_CONFLICTS 1000
+
+// thrown by solve() when a limit set by set_limits is exhausted or interrupt() was called
+struct SolveInterrupted {};
 
 class SATSolver {
 
 public:
 
-	SATSolver() {}
+	SATSolver() : clause_log(NULL) {}
 	virtual ~SATSolver() {}
 	virtual void add_clause(const std::vector<int32_t> & clause) = 0;
 	virtual void assume(int32_t lit) = 0;
 	virtual bool solve() = 0;
 	virtual bool propagate(std::vector<int32_t> & out_lits) = 0;
 	virtual bool get_value(int32_t lit) = 0;
+	virtual void simplify() = 0;
+	virtual void set_phase(int32_t lit) = 0;
+	virtual void set_activity(int32_t var, double activity) = 0;
+	virtual void set_limits(int64_t conflicts, int64_t propagations, double seconds) = 0;
+	virtual void interrupt() = 0;
+	// unit propagation for a search driven from outside: push assigns lit (or nothing if 0) at a
+	// new level and propagates, returning false on a conflict, and pop undoes the last level
+	virtual bool push(int32_t lit) = 0;
+	virtual void pop() = 0;
+	// 1 if lit is true, -1 if it is false and 0 if it is unassigned at the current level
+	virtual int8_t value(int32_t lit) = 0;
+	virtual uint32_t trail_size() = 0;
+	virtual int32_t trail_lit(uint32_t i) = 0;
+	// bytes reserved for the clause database, and whether they are backed by huge pages
+	virtual uint64_t reserved_bytes() = 0;
+	virtual bool huge_pages() = 0;
+	// called on each model found by solve(); if it adds clauses, the call resumes under the same assumptions
+	std::function<bool()> refine;
+	// if set, every clause added is also appended here
+	std::vector<std::vector<int32_t>> * clause_log;
 
 };
 
@@ -0,0 +1,52 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define SMALL_AF_MAX_ARGS 128
+
+#ifndef SMALL_AF_H
+#define SMALL_AF_H
+
+#include "DynamicAF.h"
+
+namespace SmallAF {
+
+/*
+ * Exhaustive labelling search over bitset adjacency matrices for frameworks
+ * with at most SMALL_AF_MAX_ARGS arguments, propagating conflict-freeness,
+ * defense and completeness on whole words at a time. Decides whether some
+ * extension under af.sem satisfies all the given accepted/rejected literals
+ * (cred), or whether every extension does (!cred). Requires af.attackers to
+ * be initialized. Returns 1 for yes and 0 for no, with the extension shown in
+ * witness (indexed by variable-1) if there is one, or -1 if the search
+ * exceeded its node limit and the question is left to the SAT-based solver.
+ */
+int decide(const DynamicAF & af, const std::vector<int32_t> & lits, bool cred, std::vector<uint8_t> & witness);
+
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TOTALIZER_H
+#define TOTALIZER_H
+
+#include "Encodings.h"
+
+/*
+ * Incremental totalizer over a set of input literals. Output k is implied
+ * by at least k true inputs; outputs are only encoded up to the largest
+ * bound requested so far, and extended on demand.
+ */
+class Totalizer {
+
+public:
+	Totalizer(const std::vector<int32_t> & inputs);
+	int32_t output(uint32_t k, DynamicAF & af, SAT_Solver * solver);
+	uint32_t size() const { return nodes[0].leaves; }
+
+private:
+	struct Node {
+		int32_t left, right;
+		uint32_t leaves;
+		std::vector<int32_t> outputs;
+	};
+	std::vector<Node> nodes;
+
+	int32_t build(const std::vector<int32_t> & inputs, uint32_t begin, uint32_t end);
+	void extend(int32_t node, uint32_t k, DynamicAF & af, SAT_Solver * solver);
+
+};
+
+#endif
@@ -84,7 +84,7 @@ IPAFAIR_API void * ipafair_init ();
  * Release the solver, i.e., all its resources and allocated memory. The solver
  * pointer cannot be used for any purposes after this call.
  *
- * Required state: INPUT or SAT or UNSAT or ERROR
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN or ERROR
  * State after: undefined
  */
 IPAFAIR_API void ipafair_release (void * solver);
@@ -94,7 +94,7 @@ IPAFAIR_API void ipafair_release (void * solver);
  * 
  * If the semantics is not supported by the solver, enter state ERROR.
  * 
- * Required state: INPUT or SAT or UNSAT
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
  * State after: INPUT or ERROR
  */
 IPAFAIR_API void ipafair_set_semantics (void * solver, semantics sem);
@@ -107,7 +107,7 @@ IPAFAIR_API void ipafair_set_semantics (void * solver, semantics sem);
  * Arguments are encoded as positive integers. They have to be smaller or equal
  * to INT32_MAX. This applies to all the literal arguments in API functions.
  * 
- * Required state: INPUT or SAT or UNSAT
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
  * State after: INPUT or ERROR
  */
 IPAFAIR_API void ipafair_add_argument (void * solver, int32_t arg);
@@ -119,7 +119,7 @@ IPAFAIR_API void ipafair_add_argument (void * solver, int32_t arg);
  *
  * If the argument does not exist, enter state ERROR.
  * 
- * Required state: INPUT or SAT or UNSAT
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
  * State after: INPUT or ERROR
  */
 IPAFAIR_API void ipafair_del_argument (void * solver, int32_t arg);
@@ -130,7 +130,7 @@ IPAFAIR_API void ipafair_del_argument (void * solver, int32_t arg);
  * If the attack already exists, or if s or t is not an existing argument
  * added via 'ipafair_add_argument', enter state ERROR.
  * 
- * Required state: INPUT or SAT or UNSAT
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
  * State after: INPUT or ERROR
  */
 IPAFAIR_API void ipafair_add_attack (void * solver, int32_t s, int32_t t);
@@ -140,7 +140,7 @@ IPAFAIR_API void ipafair_add_attack (void * solver, int32_t s, int32_t t);
  * 
  * If the attack does not exist, enter state ERROR.
  * 
- * Required state: INPUT or SAT or UNSAT
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
  * State after: INPUT or ERROR
  */
 IPAFAIR_API void ipafair_del_attack (void * solver, int32_t s, int32_t t);
@@ -154,7 +154,7 @@ IPAFAIR_API void ipafair_del_attack (void * solver, int32_t s, int32_t t);
  * 
  * If such an argument does not exist, enter state ERROR.
  * 
- * Required state: INPUT or SAT or UNSAT
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
  * State after: INPUT or ERROR
  */
 IPAFAIR_API void ipafair_assume (void * solver, int32_t arg);
@@ -175,12 +175,17 @@ IPAFAIR_API void ipafair_assume (void * solver, int32_t arg);
  * If the answer is 'no', return 20 and change the state of the solver to UNSAT.
  * If the solver does not support the sequence of API calls performed, return -1
  * and change the state of the solver to ERROR.
+ * If the call is interrupted via 'ipafair_interrupt', or one of the budgets set
+ * via 'ipafair_set_conflict_budget', 'ipafair_set_propagation_budget' or
+ * 'ipafair_set_time_budget' is exhausted, return 0 and change the state of the
+ * solver to UNKNOWN. In state UNKNOWN no extension is available, so
+ * 'ipafair_val' must not be called; all other functions behave as in INPUT.
  * 
  * This function can be called in any defined state of the solver. Note that
  * the state of the solver _during_ execution of 'ipafair_solve' is undefined.
  *
- * Required state: INPUT or SAT or UNSAT
- * State after: SAT or UNSAT or ERROR
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
+ * State after: SAT or UNSAT or UNKNOWN or ERROR
  */
 IPAFAIR_API int ipafair_solve_cred (void * solver);
 
@@ -200,12 +205,17 @@ IPAFAIR_API int ipafair_solve_cred (void * solver);
  * If the answer is 'no', return 20 and change the state of the solver to UNSAT.
  * If the solver does not support the sequence of API calls performed, return -1
  * and change the state of the solver to ERROR.
+ * If the call is interrupted via 'ipafair_interrupt', or one of the budgets set
+ * via 'ipafair_set_conflict_budget', 'ipafair_set_propagation_budget' or
+ * 'ipafair_set_time_budget' is exhausted, return 0 and change the state of the
+ * solver to UNKNOWN. In state UNKNOWN no extension is available, so
+ * 'ipafair_val' must not be called; all other functions behave as in INPUT.
  * 
  * This function can be called in any defined state of the solver. Note that
  * the state of the solver _during_ execution of 'ipafair_solve' is undefined.
  *
- * Required state: INPUT or SAT or UNSAT
- * State after: SAT or UNSAT or ERROR
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
+ * State after: SAT or UNSAT or UNKNOWN or ERROR
  */
 IPAFAIR_API int ipafair_solve_skept (void * solver);
 
@@ -223,6 +233,47 @@ IPAFAIR_API int ipafair_solve_skept (void * solver);
  */
 IPAFAIR_API int32_t ipafair_val (void * solver, int32_t arg);
 
+/**
+ * Limit the number of SAT solver conflicts spent in each subsequent call of
+ * 'ipafair_solve_cred' or 'ipafair_solve_skept'. A negative value removes the
+ * limit, which is the default.
+ * 
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
+ * State after: INPUT or SAT or UNSAT or UNKNOWN (unchanged)
+ */
+IPAFAIR_API void ipafair_set_conflict_budget (void * solver, int64_t conflicts);
+
+/**
+ * Limit the number of SAT solver propagations spent in each subsequent call of
+ * 'ipafair_solve_cred' or 'ipafair_solve_skept'. A negative value removes the
+ * limit, which is the default.
+ * 
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
+ * State after: INPUT or SAT or UNSAT or UNKNOWN (unchanged)
+ */
+IPAFAIR_API void ipafair_set_propagation_budget (void * solver, int64_t propagations);
+
+/**
+ * Limit the wall-clock time in seconds of each subsequent call of
+ * 'ipafair_solve_cred' or 'ipafair_solve_skept'. A negative value removes the
+ * limit, which is the default.
+ * 
+ * Required state: INPUT or SAT or UNSAT or UNKNOWN
+ * State after: INPUT or SAT or UNSAT or UNKNOWN (unchanged)
+ */
+IPAFAIR_API void ipafair_set_time_budget (void * solver, double seconds);
+
+/**
+ * Ask a running call of 'ipafair_solve_cred' or 'ipafair_solve_skept' to stop
+ * as soon as possible, in which case it returns 0. This is the only function
+ * that may be called from another thread while the solver is running. It has
+ * no effect on calls started afterwards.
+ * 
+ * Required state: any
+ * State after: unchanged
+ */
+IPAFAIR_API void ipafair_interrupt (void * solver);
+
 #ifdef __cplusplus
 } // closing extern "C"
 #endif
@@ -28,12 +28,20 @@
 
 #define INITIAL_BUFFER_SIZE 16
 #define MAX_EXTENSIONS 8
+#define MAX_RETIRED_VARS 65536
+#define LS_FLIPS_PER_ARG 100
 
 #ifndef AF_SOLVER_H
 #define AF_SOLVER_H
 
 #include "DynamicAF.h"
 
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
 #if defined(SAT_GLUCOSE)
 #include "GlucoseSolver.h"
 typedef GlucoseSolver SAT_Solver;
@@ -44,7 +52,9 @@ typedef CryptoMiniSatSolver SAT_Solver;
 #error "No SAT solver defined"
 #endif
 
-enum state { INPUT = 0, ACCEPT = 10, REJECT = 20, ERROR = -1 };
+#include "Totalizer.h"
+
+enum state { INPUT = 0, ACCEPT = 10, REJECT = 20, UNKNOWN = 30, ERROR = -1 };
 
 class AFSolver {
 
@@ -59,10 +69,15 @@ public:
 	void assume_in(int32_t arg);
 	void assume_out(int32_t arg);
 	void solve(bool cred);
+	void set_conflict_budget(int64_t conflicts) { conflict_budget = conflicts; }
+	void set_propagation_budget(int64_t propagations) { propagation_budget = propagations; }
+	void set_time_budget(double seconds) { time_budget = seconds; }
+	void interrupt();
 	int32_t get_val_in(int32_t arg);
 	int32_t get_val_out(int32_t arg);
 	state get_state() { return current_state; }
 	void set_static() { dynamic_af.static_mode = true; }
+	void print_stats();
 
 private:
 	DynamicAF dynamic_af;
@@ -75,13 +90,68 @@ private:
 	state current_state;
 	uint32_t buffer_size;
 
+	// limits for each call of solve, negative values disable them
+	int64_t conflict_budget;
+	int64_t propagation_budget;
+	double time_budget;
+	std::chrono::steady_clock::time_point call_start;
+	std::atomic<bool> interrupted;
+	// guards sat_solver against interrupt() from other threads while it is rebuilt
+	std::mutex solver_mutex;
+	// literals disabling the clauses of finished queries, fixed at the start of the next solve
+	std::vector<int32_t> retiring;
+	uint32_t retired_vars;
+
+	// framework-level objects, valid while memo_version == dynamic_af.version
+	uint64_t memo_version;
+	bool grounded_known;
+	bool ideal_known;
+	bool stable_known;
+	bool stable_exists;
+	std::vector<int32_t> grounded;
+	std::vector<uint8_t> ideal_extension;
+	std::vector<uint8_t> witness;
+	// CEGAR knowledge for the current framework under knowledge_sem: maximal extensions
+	// and clauses refuting non-maximal candidates, active in sat_solver under knowledge_select
+	sigma knowledge_sem;
+	std::vector<std::vector<uint8_t>> maximal_extensions;
+	std::vector<std::vector<int32_t>> refutations;
+	int32_t knowledge_select;
+	uint32_t refutations_added;
+
+	// range cores that hold for the current framework under the encoding of range_cores_sem
+	std::vector<std::vector<int32_t>> range_cores;
+	sigma range_cores_sem;
+	// totalizers encoded into the current sat_solver, indexed by their inputs
+	std::vector<Totalizer> totalizers;
+	std::map<std::vector<int32_t>, uint32_t> totalizer_index;
+	std::unordered_map<int32_t, std::pair<uint32_t, uint32_t>> soft_bounds;
+
+	int32_t new_selector();
+	void retire_selectors();
+	void decide(bool cred);
+	void set_limits();
+	void update_memo();
+	void compute_grounded();
+	bool lookup(bool cred);
 	void assume_current_structure(SAT_Solver * solver);
 	void assume_grounded(SAT_Solver * solver);
 	void assume_range(SAT_Solver * solver);
 	void set_objective_vars();
 	bool check_extensions(int32_t target, int32_t select);
-	bool cegar(int32_t target, int32_t select);
+	void replay_knowledge();
+	void add_refutation(const std::vector<int32_t> & refutation);
+	bool cegar(int32_t target, int32_t select, bool learn);
+	uint32_t get_totalizer(const std::vector<int32_t> & inputs);
+	void relax(const std::vector<int32_t> & core, std::vector<int32_t> & soft);
+	void maximize_range(int32_t target, int32_t select);
+	bool cegar_range(int32_t target, int32_t select);
+	void seed_heuristics();
+	bool local_search_stable(const std::vector<int32_t> & lits);
+	bool preferred_mcs(int32_t target, int32_t select, const std::vector<int32_t> & lits);
 	bool ideal(int32_t target, int32_t select);
+	void ideal_fixpoint(int32_t select);
+	bool decide_small(bool cred);
 
 };
 
@@ -187,6 +187,10 @@ verbosity(0)
 , propagation_budget(-1)
 , asynch_interrupt(false)
 , incremental(false)
+, keepAssumptionTrail(false)
+, implicitBinaries(false)
+, compactInPlace(false)
+, binConflictLit(lit_Undef)
 , nbVarsInitialFormula(INT32_MAX)
 , totalTime4Sat(0.)
 , totalTime4Unsat(0.)
@@ -272,6 +276,10 @@ Solver::Solver(const Solver &s) :
 , propagation_budget(s.propagation_budget)
 , asynch_interrupt(s.asynch_interrupt)
 , incremental(s.incremental)
+, keepAssumptionTrail(s.keepAssumptionTrail)
+, implicitBinaries(s.implicitBinaries)
+, compactInPlace(s.compactInPlace)
+, binConflictLit(s.binConflictLit)
 , nbVarsInitialFormula(s.nbVarsInitialFormula)
 , totalTime4Sat(s.totalTime4Sat)
 , totalTime4Unsat(s.totalTime4Unsat)
@@ -450,6 +458,8 @@ bool Solver::addClause_(vec <Lit> &ps) {
     else if(ps.size() == 1) {
         uncheckedEnqueue(ps[0]);
         return ok = (propagate() == CRef_Undef);
+    } else if(ps.size() == 2 && implicitBinaries) {
+        attachBinary(ps[0], ps[1]);
     } else {
         CRef cr = ca.alloc(ps, false);
         clauses.push(cr);
@@ -476,6 +486,13 @@ void Solver::attachClause(CRef cr) {
 }
 
 
+void Solver::attachBinary(Lit p, Lit q) {
+    watchesBin[~p].push(Watcher(binRef(p), q));
+    watchesBin[~q].push(Watcher(binRef(q), p));
+    stats[clauses_literals] += 2;
+}
+
+
 void Solver::attachClausePurgatory(CRef cr) {
     const Clause &c = ca[cr];
 
@@ -743,49 +760,58 @@ void Solver::analyze(CRef confl, vec <Lit> &out_learnt, vec <Lit> &selectors, in
     int index = trail.size() - 1;
     do {
         assert(confl != CRef_Undef); // (otherwise should be UIP)
-        Clause &c = ca[confl];
-        // Special case for binary clauses
-        // The first one has to be SAT
-        if(p != lit_Undef && c.size() == 2 && value(c[0]) == l_False) {
-
-            assert(value(c[1]) == l_True);
-            Lit tmp = c[0];
-            c[0] = c[1], c[1] = tmp;
-        }
-
-        if(c.learnt()) {
-            parallelImportClauseDuringConflictAnalysis(c, confl);
-            claBumpActivity(c);
-        } else { // original clause
-            if(!c.getSeen()) {
-                stats[originalClausesSeen]++;
-                c.setSeen(true);
+        Lit bin[2];
+        Clause *cl = NULL;
+        if(isBinRef(confl)) {
+            // Implicit binary clause: the reason of p, or both literals of the conflict
+            bin[0] = (p == lit_Undef) ? binConflictLit : p;
+            bin[1] = binRefLit(confl);
+        } else {
+            Clause &c = ca[confl];
+            cl = &c;
+            // Special case for binary clauses
+            // The first one has to be SAT
+            if(p != lit_Undef && c.size() == 2 && value(c[0]) == l_False) {
+
+                assert(value(c[1]) == l_True);
+                Lit tmp = c[0];
+                c[0] = c[1], c[1] = tmp;
             }
-        }
 
-        // DYNAMIC NBLEVEL trick (see competition'09 companion paper)
-        if(c.learnt() && c.lbd() > 2) {
-            unsigned int nblevels = computeLBD(c);
-            if(nblevels + 1 < c.lbd()) { // improve the LBD
-                if(c.lbd() <= lbLBDFrozenClause) {
-                    // seems to be interesting : keep it for the next round
-                    c.setCanBeDel(false);
+            if(c.learnt()) {
+                parallelImportClauseDuringConflictAnalysis(c, confl);
+                claBumpActivity(c);
+            } else { // original clause
+                if(!c.getSeen()) {
+                    stats[originalClausesSeen]++;
+                    c.setSeen(true);
                 }
-                if(chanseokStrategy && nblevels <= coLBDBound) {
-                    c.nolearnt();
-                    learnts.remove(confl);
-                    permanentLearnts.push(confl);
-                    stats[nbPermanentLearnts]++;
+            }
 
-                } else {
-                    c.setLBD(nblevels); // Update it
+            // DYNAMIC NBLEVEL trick (see competition'09 companion paper)
+            if(c.learnt() && c.lbd() > 2) {
+                unsigned int nblevels = computeLBD(c);
+                if(nblevels + 1 < c.lbd()) { // improve the LBD
+                    if(c.lbd() <= lbLBDFrozenClause) {
+                        // seems to be interesting : keep it for the next round
+                        c.setCanBeDel(false);
+                    }
+                    if(chanseokStrategy && nblevels <= coLBDBound) {
+                        c.nolearnt();
+                        learnts.remove(confl);
+                        permanentLearnts.push(confl);
+                        stats[nbPermanentLearnts]++;
+
+                    } else {
+                        c.setLBD(nblevels); // Update it
+                    }
                 }
             }
         }
 
 
-        for(int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++) {
-            Lit q = c[j];
+        for(int j = (p == lit_Undef) ? 0 : 1; j < (cl ? cl->size() : 2); j++) {
+            Lit q = cl ? (*cl)[j] : bin[j];
 
             if(!seen[var(q)]) {
                 if(level(var(q)) == 0) {
@@ -801,7 +827,7 @@ void Solver::analyze(CRef confl, vec <Lit> &out_learnt, vec <Lit> &selectors, in
                     if(level(var(q)) >= decisionLevel()) {
                         pathC++;
                         // UPDATEVARACTIVITY trick (see competition'09 companion paper)
-                        if(!isSelector(var(q)) && (reason(var(q)) != CRef_Undef) && ca[reason(var(q))].learnt())
+                        if(!isSelector(var(q)) && (reason(var(q)) != CRef_Undef) && !isBinRef(reason(var(q))) && ca[reason(var(q))].learnt())
                             lastDecisionLevel.push(q);
                     } else {
                         if(isSelector(var(q))) {
@@ -848,7 +874,11 @@ void Solver::analyze(CRef confl, vec <Lit> &out_learnt, vec <Lit> &selectors, in
 
             if(reason(x) == CRef_Undef)
                 out_learnt[j++] = out_learnt[i];
-            else {
+            else if(isBinRef(reason(x))) {
+                Lit q = binRefLit(reason(x));
+                if(!seen[var(q)] && level(var(q)) > 0)
+                    out_learnt[j++] = out_learnt[i];
+            } else {
                 Clause &c = ca[reason(var(out_learnt[i]))];
                 // Thanks to Siert Wieringa for this bug fix!
                 for(int k = ((c.size() == 2) ? 0 : 1); k < c.size(); k++)
@@ -929,16 +959,18 @@ bool Solver::litRedundant(Lit p, uint32_t abstract_levels) {
     int top = analyze_toclear.size();
     while(analyze_stack.size() > 0) {
         assert(reason(var(analyze_stack.last())) != CRef_Undef);
-        Clause &c = ca[reason(var(analyze_stack.last()))];
+        CRef cr = reason(var(analyze_stack.last()));
         analyze_stack.pop(); //
-        if(c.size() == 2 && value(c[0]) == l_False) {
-            assert(value(c[1]) == l_True);
-            Lit tmp = c[0];
-            c[0] = c[1], c[1] = tmp;
+        Lit bin = isBinRef(cr) ? binRefLit(cr) : lit_Undef;
+        Clause *c = isBinRef(cr) ? NULL : &ca[cr];
+        if(c && c->size() == 2 && value((*c)[0]) == l_False) {
+            assert(value((*c)[1]) == l_True);
+            Lit tmp = (*c)[0];
+            (*c)[0] = (*c)[1], (*c)[1] = tmp;
         }
 
-        for(int i = 1; i < c.size(); i++) {
-            Lit p = c[i];
+        for(int i = 1; i < (c ? c->size() : 2); i++) {
+            Lit p = c ? (*c)[i] : bin;
             if(!seen[var(p)]) {
                 if(level(var(p)) > 0) {
                     if(reason(var(p)) != CRef_Undef && (abstractLevel(var(p)) & abstract_levels) != 0) {
@@ -984,6 +1016,10 @@ void Solver::analyzeFinal(Lit p, vec <Lit> &out_conflict) {
             if(reason(x) == CRef_Undef) {
                 assert(level(x) > 0);
                 out_conflict.push(~trail[i]);
+            } else if(isBinRef(reason(x))) {
+                Lit q = binRefLit(reason(x));
+                if(level(var(q)) > 0)
+                    seen[var(q)] = 1;
             } else {
                 Clause &c = ca[reason(x)];
                 //                for (int j = 1; j < c.size(); j++) Minisat (glucose 2.0) loop
@@ -1047,6 +1083,7 @@ CRef Solver::propagate() {
             Lit imp = wbin[k].blocker;
 
             if(value(imp) == l_False) {
+                if(isBinRef(wbin[k].cref)) binConflictLit = imp;
                 return wbin[k].cref;
             }
 
@@ -1302,6 +1339,59 @@ void Solver::removeSatisfied(vec <CRef> &cs) {
 }
 
 
+void Solver::removeSatisfiedBinaries() {
+    // An implicit binary lives only in its two watchers, so each watcher is dropped on its own
+    for(int v = 0; v < nVars(); v++)
+        for(int s = 0; s < 2; s++) {
+            Lit p = mkLit(v, s);
+            vec <Watcher> &ws = watchesBin[p];
+            int i, j;
+            for(i = j = 0; i < ws.size(); i++)
+                if(isBinRef(ws[i].cref) && (value(~p) == l_True || value(ws[i].blocker) == l_True))
+                    stats[clauses_literals]--;
+                else
+                    ws[j++] = ws[i];
+            ws.shrink(i - j);
+        }
+}
+
+
+int Solver::nBinaryWatches() {
+    int n = 0;
+    for(int v = 0; v < nVars(); v++)
+        for(int s = 0; s < 2; s++) {
+            vec <Watcher> &ws = watchesBin[mkLit(v, s)];
+            for(int i = 0; i < ws.size(); i++)
+                if(isBinRef(ws[i].cref)) n++;
+        }
+    return n;
+}
+
+
+int Solver::nArenaBinaryWatches() {
+    int n = 0;
+    for(int v = 0; v < nVars(); v++)
+        for(int s = 0; s < 2; s++) {
+            vec <Watcher> &ws = watchesBin[mkLit(v, s)];
+            for(int i = 0; i < ws.size(); i++)
+                if(!isBinRef(ws[i].cref)) n++;
+        }
+    return n;
+}
+
+
+int Solver::nArenaBinaries() {
+    int n = 0;
+    vec <CRef> *lists[] = {&clauses, &learnts, &permanentLearnts};
+    for(int l = 0; l < 3; l++)
+        for(int i = 0; i < lists[l]->size(); i++) {
+            const Clause &c = ca[(*lists[l])[i]];
+            if(c.size() == 2 && c.mark() != 1) n++;
+        }
+    return n;
+}
+
+
 void Solver::rebuildOrderHeap() {
     vec <Var> vs;
     for(Var v = 0; v < nVars(); v++)
@@ -1339,8 +1429,10 @@ bool Solver::simplify() {
     removeSatisfied(learnts);
     removeSatisfied(permanentLearnts);
     removeSatisfied(unaryWatchedClauses);
-    if(remove_satisfied) // Can be turned off.
+    if(remove_satisfied) { // Can be turned off.
         removeSatisfied(clauses);
+        if(implicitBinaries) removeSatisfiedBinaries();
+    }
     checkGarbage();
     rebuildOrderHeap();
 
@@ -1819,7 +1911,12 @@ lbool Solver::solve_(bool do_simp, bool turn_off_simp) // Parameters are useless
         ok = false;
 
 
-    cancelUntil(0);
+    // The levels of the assumptions are at a propagation fixpoint, and the
+    // caller backtracks to the prefix it shares with the next assumptions
+    if(keepAssumptionTrail && ok)
+        cancelUntil(decisionLevel() < assumptions.size() ? decisionLevel() : assumptions.size());
+    else
+        cancelUntil(0);
 
 
     double finalTime = cpuTime();
@@ -1935,7 +2032,7 @@ void Solver::relocAll(ClauseAllocator &to) {
                 ca.reloc(ws[j].cref, to);
             vec <Watcher> &ws2 = watchesBin[p];
             for(int j = 0; j < ws2.size(); j++)
-                ca.reloc(ws2[j].cref, to);
+                if(!isBinRef(ws2[j].cref)) ca.reloc(ws2[j].cref, to);
             vec <Watcher> &ws3 = unaryWatches[p];
             for(int j = 0; j < ws3.size(); j++)
                 ca.reloc(ws3[j].cref, to);
@@ -1946,7 +2043,7 @@ void Solver::relocAll(ClauseAllocator &to) {
     for(int i = 0; i < trail.size(); i++) {
         Var v = var(trail[i]);
 
-        if(reason(v) != CRef_Undef && (ca[reason(v)].reloced() || locked(ca[reason(v)])))
+        if(reason(v) != CRef_Undef && !isBinRef(reason(v)) && (ca[reason(v)].reloced() || locked(ca[reason(v)])))
             ca.reloc(vardata[v].reason, to);
     }
 
@@ -1968,7 +2065,54 @@ void Solver::relocAll(ClauseAllocator &to) {
 }
 
 
+void Solver::forwardAll() {
+    // All watchers (the watch lists hold no deleted clauses at this point):
+    for(int v = 0; v < nVars(); v++)
+        for(int s = 0; s < 2; s++) {
+            Lit p = mkLit(v, s);
+            vec <Watcher> &ws = watches[p];
+            for(int j = 0; j < ws.size(); j++)
+                ca.forward(ws[j].cref);
+            vec <Watcher> &ws2 = watchesBin[p];
+            for(int j = 0; j < ws2.size(); j++)
+                if(!isBinRef(ws2[j].cref)) ca.forward(ws2[j].cref);
+            vec <Watcher> &ws3 = unaryWatches[p];
+            for(int j = 0; j < ws3.size(); j++)
+                ca.forward(ws3[j].cref);
+        }
+
+    // All reasons (those of deleted clauses are not kept):
+    for(int i = 0; i < trail.size(); i++) {
+        Var v = var(trail[i]);
+        if(reason(v) != CRef_Undef && !isBinRef(reason(v)) && !ca.forward(vardata[v].reason))
+            vardata[v].reason = CRef_Undef;
+    }
+
+    for(int i = 0; i < learnts.size(); i++)
+        ca.forward(learnts[i]);
+    for(int i = 0; i < permanentLearnts.size(); i++)
+        ca.forward(permanentLearnts[i]);
+    for(int i = 0; i < clauses.size(); i++)
+        ca.forward(clauses[i]);
+    for(int i = 0; i < unaryWatchedClauses.size(); i++)
+        ca.forward(unaryWatchedClauses[i]);
+}
+
+
 void Solver::garbageCollect() {
+    if(compactInPlace) {
+        uint32_t before = ca.size();
+        // Deleted clauses are recognised by their mark only until they are overwritten
+        watches.cleanAll();
+        watchesBin.cleanAll();
+        unaryWatches.cleanAll();
+        ca.compact();
+        forwardAll();
+        if(verbosity >= 2)
+            printf("|  Garbage collection:   %12d bytes => %12d bytes (in place)    |\n",
+                   before * ClauseAllocator::Unit_Size, ca.size() * ClauseAllocator::Unit_Size);
+        return;
+    }
     // Initialize the next region to a size corresponding to the estimated utilization degree. This
     // is not precise but should avoid some unnecessary reallocations for the new region:
     ClauseAllocator to(ca.size() - ca.wasted());
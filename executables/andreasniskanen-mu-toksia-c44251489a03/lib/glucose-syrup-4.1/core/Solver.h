@@ -166,6 +166,9 @@ public:
     int     nClauses   ()      const;       // The current number of original clauses.
     int     nLearnts   ()      const;       // The current number of learnt clauses.
     int     nVars      ()      const;       // The current number of variables.
+    int     nBinaryWatches()   ;            // The current number of watchers of implicit binary clauses.
+    int     nArenaBinaryWatches();          // The current number of watchers of binary clauses in the arena, including lazily detached ones.
+    int     nArenaBinaries()   ;            // The current number of binary clauses in the arena that are not deleted.
     int     nFreeVars  ()      ;
 
     inline char valuePhase(Var v) {return polarity[v];}
@@ -289,6 +292,13 @@ protected:
     struct VarData { CRef reason; int level; };
     static inline VarData mkVarData(CRef cr, int l){ VarData d = {cr, l}; return d; }
 
+    // Implicit binary clauses are not stored in the clause arena: their watchers and
+    // the reasons they imply hold the other literal of the clause, tagged by the top bit
+    static const CRef CRef_Bin = 0x80000000;
+    static inline CRef binRef   (Lit other) { return CRef_Bin | (CRef)toInt(other); }
+    static inline bool isBinRef (CRef cr)   { return cr != CRef_Undef && (cr & CRef_Bin); }
+    static inline Lit  binRefLit(CRef cr)   { return toLit(cr & ~CRef_Bin); }
+
     struct Watcher {
         CRef cref;
         Lit  blocker;
@@ -307,7 +317,7 @@ protected:
     {
         const ClauseAllocator& ca;
         WatcherDeleted(const ClauseAllocator& _ca) : ca(_ca) {}
-        bool operator()(const Watcher& w) const { return ca[w.cref].mark() == 1; }
+        bool operator()(const Watcher& w) const { return !isBinRef(w.cref) && ca[w.cref].mark() == 1; }
     };
 
     struct VarOrderLt {
@@ -391,6 +401,10 @@ protected:
 
     // Variables added for incremental mode
     int incremental; // Use incremental SAT Solver
+    bool keepAssumptionTrail; // Keep the decision levels of the assumptions after solving, to be reused by the next call
+    bool implicitBinaries; // Keep binary problem clauses in the watch lists only, outside the clause arena
+    bool compactInPlace; // Garbage collection slides the live clauses down in the arena instead of copying them
+    Lit binConflictLit; // The other false literal when propagate() returns an implicit binary clause
     int nbVarsInitialFormula; // nb VAR in formula without assumptions (incremental SAT)
     double totalTime4Sat,totalTime4Unsat;
     int nbSatCalls,nbUnsatCalls;
@@ -414,6 +428,7 @@ protected:
     virtual lbool    solve_           (bool do_simp = true, bool turn_off_simp = false);                                                      // Main solve method (assumptions given in 'assumptions').
     virtual void     reduceDB         ();                                              // Reduce the set of learnt clauses.
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
+    void     removeSatisfiedBinaries();                                                // Drop implicit binary clauses satisfied at the root from the watcher lists.
     void     rebuildOrderHeap ();
 
     void     adaptSolver();                                                            // Adapt solver strategies
@@ -429,6 +444,7 @@ protected:
     // Operations on clauses:
     //
     void     attachClause     (CRef cr);               // Attach a clause to watcher lists.
+    void     attachBinary     (Lit p, Lit q);          // Attach an implicit binary clause to watcher lists.
     void     detachClause     (CRef cr, bool strict = false); // Detach a clause to watcher lists.
     void     detachClausePurgatory(CRef cr, bool strict = false);
     void     attachClausePurgatory(CRef cr);
@@ -440,6 +456,7 @@ protected:
     void minimisationWithBinaryResolution(vec<Lit> &out_learnt);
 
     virtual void     relocAll         (ClauseAllocator& to);
+    void             forwardAll       ();                      // Update all references after compacting the arena in place.
 
     // Misc:
     //
@@ -511,11 +528,11 @@ inline bool     Solver::addClause       (Lit p, Lit q)          { add_tmp.clear(
 inline bool     Solver::addClause       (Lit p, Lit q, Lit r)   { add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); add_tmp.push(r); return addClause_(add_tmp); }
  inline bool     Solver::locked          (const Clause& c) const { 
    if(c.size()>2) 
-     return value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && ca.lea(reason(var(c[0]))) == &c; 
+     return value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && !isBinRef(reason(var(c[0]))) && ca.lea(reason(var(c[0]))) == &c; 
    return 
-     (value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && ca.lea(reason(var(c[0]))) == &c)
+     (value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && !isBinRef(reason(var(c[0]))) && ca.lea(reason(var(c[0]))) == &c)
      || 
-     (value(c[1]) == l_True && reason(var(c[1])) != CRef_Undef && ca.lea(reason(var(c[1]))) == &c);
+     (value(c[1]) == l_True && reason(var(c[1])) != CRef_Undef && !isBinRef(reason(var(c[1]))) && ca.lea(reason(var(c[1]))) == &c);
  }
 inline void     Solver::newDecisionLevel()                      { trail_lim.push(trail.size()); }
 
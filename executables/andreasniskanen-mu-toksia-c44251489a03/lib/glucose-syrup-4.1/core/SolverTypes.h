@@ -281,6 +281,7 @@ public:
     {
         static int clauseWord32Size(int size, int extra_size){
             return (sizeof(Clause) + (sizeof(Lit) * (size + extra_size))) / sizeof(uint32_t); }
+        vec<CRef> moved_from, moved_to;
     public:
         bool extra_clause_field;
 
@@ -300,6 +301,9 @@ public:
             bool use_extra = learnt | extra_clause_field;
             int extra_size = imported?3:(use_extra?1:0);
             CRef cid = RegionAllocator<uint32_t>::alloc(clauseWord32Size(ps.size(), extra_size));
+            // The top bit of a reference is left free to tag implicit binary clauses
+            if (size() > 0x80000000)
+                throw OutOfMemoryException();
             new (lea(cid)) Clause(ps, extra_size, learnt);
 
             return cid;
@@ -318,6 +322,41 @@ public:
             RegionAllocator<uint32_t>::free(clauseWord32Size(c.size(), c.has_extra()));
         }
 
+        // Slide the clauses not marked as deleted towards the start of the region, keeping
+        // their order; 'forward' then maps old references to new ones until the next call
+        void compact()
+        {
+            moved_from.clear();
+            moved_to.clear();
+            uint32_t dst = 0;
+            for (uint32_t src = 0; src < size(); ) {
+                Clause& c = operator[](src);
+                uint32_t words = clauseWord32Size(c.size(), c.header.extra_size);
+                if (c.mark() != 1) {
+                    moved_from.push(src);
+                    moved_to.push(dst);
+                    if (dst != src)
+                        memmove(lea(dst), &c, words * sizeof(uint32_t));
+                    dst += words;
+                }
+                src += words;
+            }
+            truncate(dst);
+        }
+
+        bool forward(CRef& cr) const
+        {
+            int lo = 0, hi = moved_from.size();
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (moved_from[mid] < cr) lo = mid + 1;
+                else hi = mid;
+            }
+            if (lo == moved_from.size() || moved_from[lo] != cr) return false;
+            cr = moved_to[lo];
+            return true;
+        }
+
         void reloc(CRef& cr, ClauseAllocator& to)
         {
             Clause& c = operator[](cr);
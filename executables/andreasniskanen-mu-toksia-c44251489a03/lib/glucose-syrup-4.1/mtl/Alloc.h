@@ -36,8 +36,15 @@ class RegionAllocator
     uint32_t  sz;
     uint32_t  cap;
     uint32_t  wasted_;
+    bool      huge;    // Grow into a mapping backed by transparent huge pages
+    bool      mapped;  // 'memory' is such a mapping rather than a malloc'd block
 
     void capacity(uint32_t min_cap);
+    void release();
+
+ protected:
+    // Drop everything from 'new_sz' on, after its contents were compacted below it:
+    void truncate(uint32_t new_sz);
 
  public:
     // TODO: make this a class for better type-checking?
@@ -45,17 +52,19 @@ class RegionAllocator
     enum { Ref_Undef = UINT32_MAX };
     enum { Unit_Size = sizeof(uint32_t) };
 
-    explicit RegionAllocator(uint32_t start_cap = 1024*1024) : memory(NULL), sz(0), cap(0), wasted_(0){ capacity(start_cap); }
+    explicit RegionAllocator(uint32_t start_cap = 1024*1024) : memory(NULL), sz(0), cap(0), wasted_(0), huge(false), mapped(false){ capacity(start_cap); }
     ~RegionAllocator()
     {
-        if (memory != NULL)
-            ::free(memory);
+        release();
     }
 
 
     uint32_t size      () const      { return sz; }
     uint32_t getCap    () const      { return cap;}
     uint32_t wasted    () const      { return wasted_; }
+    uint64_t reserved  () const      { return (uint64_t)cap * sizeof(T); }
+    bool     hugePages () const      { return mapped; }
+    void     setHugePages(bool b)    { huge = b; }
 
     Ref      alloc     (int size); 
     void     free      (int size)    { wasted_ += size; }
@@ -70,18 +79,21 @@ class RegionAllocator
         return  (Ref)(t - &memory[0]); }
 
     void     moveTo(RegionAllocator& to) {
-        if (to.memory != NULL) ::free(to.memory);
+        to.release();
         to.memory = memory;
         to.sz = sz;
         to.cap = cap;
         to.wasted_ = wasted_;
+        to.mapped = mapped;
 
         memory = NULL;
         sz = cap = wasted_ = 0;
+        mapped = false;
     }
 
     void copyTo(RegionAllocator& to) const {
      //   if (to.memory != NULL) ::free(to.memory);
+        if (to.mapped) to.release();
         to.memory = (T*)xrealloc(to.memory, sizeof(T)*cap);
         memcpy(to.memory,memory,sizeof(T)*cap);        
         to.sz = sz;
@@ -112,10 +124,56 @@ void RegionAllocator<T>::capacity(uint32_t min_cap)
     //printf(" .. (%p) cap = %u\n", this, cap);
 
     assert(cap > 0);
+#if defined(XMAP_SUPPORTED)
+    if (huge && sizeof(T)*cap >= xmap_page) {
+        if (mapped)
+            memory = (T*)xmap(memory, sizeof(T)*prev_cap, sizeof(T)*cap);
+        else {
+            T* region = (T*)xmap(NULL, 0, sizeof(T)*cap);
+            if (memory != NULL) {
+                memcpy(region, memory, sizeof(T)*sz);
+                ::free(memory);
+            }
+            memory = region;
+            mapped = true;
+        }
+        return;
+    }
+#endif
     memory = (T*)xrealloc(memory, sizeof(T)*cap);
 }
 
 
+template<class T>
+void RegionAllocator<T>::release()
+{
+    if (memory == NULL) return;
+#if defined(XMAP_SUPPORTED)
+    if (mapped) {
+        xunmap(memory, sizeof(T)*cap);
+        memory = NULL;
+        mapped = false;
+        return;
+    }
+#endif
+    ::free(memory);
+    memory = NULL;
+}
+
+
+template<class T>
+void RegionAllocator<T>::truncate(uint32_t new_sz)
+{
+    assert(new_sz <= sz);
+    sz = new_sz;
+    wasted_ = 0;
+#if defined(XMAP_SUPPORTED)
+    if (mapped)
+        xmapdiscard(memory, sizeof(T)*sz, sizeof(T)*cap);
+#endif
+}
+
+
 template<class T>
 typename RegionAllocator<T>::Ref
 RegionAllocator<T>::alloc(int size)
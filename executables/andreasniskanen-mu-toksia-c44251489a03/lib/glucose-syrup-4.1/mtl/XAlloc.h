@@ -24,6 +24,9 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 namespace Glucose {
 
@@ -41,6 +44,39 @@ static inline void* xrealloc(void *ptr, size_t size)
 	}
 }
 
+//=================================================================================================
+// Anonymous mappings advised to be backed by transparent huge pages, for large regions:
+
+#if defined(__linux__)
+#define XMAP_SUPPORTED 1
+static const size_t xmap_page = 2*1024*1024;
+static inline size_t xmapsize(size_t size) { return (size + xmap_page - 1) & ~(xmap_page - 1); }
+
+// Map a region of 'new_size' bytes, moving the 'old_size' bytes of a previous mapping 'ptr' if given:
+static inline void* xmap(void *ptr, size_t old_size, size_t new_size)
+{
+    void* mem = (ptr == NULL)
+        ? mmap(NULL, xmapsize(new_size), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+        : mremap(ptr, xmapsize(old_size), xmapsize(new_size), MREMAP_MAYMOVE);
+    if (mem == MAP_FAILED)
+        throw OutOfMemoryException();
+#if defined(MADV_HUGEPAGE)
+    madvise(mem, xmapsize(new_size), MADV_HUGEPAGE);
+#endif
+    return mem;
+}
+
+// Give the pages after the first 'used' bytes back to the system; they read as zero when touched again:
+static inline void xmapdiscard(void *ptr, size_t used, size_t size)
+{
+    size_t keep = xmapsize(used);
+    if (keep < xmapsize(size))
+        madvise((char*)ptr + keep, xmapsize(size) - keep, MADV_DONTNEED);
+}
+
+static inline void xunmap(void *ptr, size_t size) { munmap(ptr, xmapsize(size)); }
+#endif
+
 //=================================================================================================
 }
 
@@ -1,6 +1,6 @@
 from . import ipafair
 import os
-from ctypes import cdll, c_void_p, c_int
+from ctypes import cdll, c_void_p, c_int, c_int64, c_double
 
 LIBNAME = "libmu-toksia.so"
 LIBPATH = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "build", "dynamic", "lib", LIBNAME)
@@ -29,6 +29,10 @@ class mu_toksia(ipafair.AFSolver):
         self.lib.ipafair_solve_skept.argtypes = [c_void_p]
         self.lib.ipafair_val.restype = c_int
         self.lib.ipafair_val.argtypes = [c_void_p, c_int]
+        self.lib.ipafair_set_conflict_budget.argtypes = [c_void_p, c_int64]
+        self.lib.ipafair_set_propagation_budget.argtypes = [c_void_p, c_int64]
+        self.lib.ipafair_set_time_budget.argtypes = [c_void_p, c_double]
+        self.lib.ipafair_interrupt.argtypes = [c_void_p]
 
         self.solver = self.lib.ipafair_init()
         self.lib.ipafair_set_semantics(self.solver, semantics_to_code[sigma])
@@ -90,6 +94,18 @@ class mu_toksia(ipafair.AFSolver):
             return False
         return None
 
+    def set_conflict_budget(self, conflicts: int):
+        self.lib.ipafair_set_conflict_budget(self.solver, conflicts)
+
+    def set_propagation_budget(self, propagations: int):
+        self.lib.ipafair_set_propagation_budget(self.solver, propagations)
+
+    def set_time_budget(self, seconds: float):
+        self.lib.ipafair_set_time_budget(self.solver, seconds)
+
+    def interrupt(self):
+        self.lib.ipafair_interrupt(self.solver)
+
     def extract_witness(self):
         if (self.status == 10 and self.last_call is True) or (self.status == 20 and self.last_call is False):
             extension = []
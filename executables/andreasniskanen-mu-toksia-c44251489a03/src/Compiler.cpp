@@ -0,0 +1,701 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Compiler.h"
+#include "Preprocessor.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+Compiler::Compiler(const vector<vector<int32_t>> & clauses, uint32_t n_threads, uint32_t n_vars)
+	: clauses(clauses), vars(n_vars), false_node(0), true_node(0), root_conflict(false), by_shape(false), idle(0), finished(false),
+	pending(0), node_chunks(1 << (32-COMPILER_NODE_CHUNK_BITS)), node_count(0)
+{
+	for (uint32_t i = 0; i < COMPILER_NODE_SHARDS; i++)
+		node_index[i].slots.assign(COMPILER_NODE_SHARD_SLOTS, make_pair(0, 0));
+	uint32_t clause_vars = 0;
+	for (uint32_t c = 0; c < clauses.size(); c++) {
+		for (uint32_t j = 0; j < clauses[c].size(); j++)
+			clause_vars = max<uint32_t>(clause_vars, abs(clauses[c][j]));
+	}
+	vars = max(vars, clause_vars);
+	occurrences.resize(vars+1);
+	for (uint32_t c = 0; c < clauses.size(); c++) {
+		for (uint32_t j = 0; j < clauses[c].size(); j++) {
+			vector<uint32_t> & occ = occurrences[abs(clauses[c][j])];
+			if (occ.empty() || occ.back() != c) occ.push_back(c);
+		}
+	}
+	rank.assign(vars+1, 0);
+	for (uint32_t i = 0; i < max<uint32_t>(n_threads, 1); i++) {
+		Worker * w = new Worker();
+		w->index = i;
+		// models only cover the variables of the clauses, as the others are never decided
+		w->solver = new SAT_Solver(clause_vars, clause_vars);
+		w->oracle = new SAT_Solver(clause_vars, clause_vars);
+		for (uint32_t c = 0; c < clauses.size(); c++) {
+			w->solver->add_clause(clauses[c]);
+			w->oracle->add_clause(clauses[c]);
+		}
+		// the first level holds the consequences of the unit clauses, and is never popped
+		if (!w->solver->push(0)) root_conflict = true;
+		w->stamp = 0;
+		w->var_in.assign(vars+1, 0);
+		w->var_seen.assign(vars+1, 0);
+		w->clause_in.assign(clauses.size(), 0);
+		w->clause_seen.assign(clauses.size(), 0);
+		w->score.assign(vars+1, 0);
+		w->local.assign(vars+1, 0);
+		workers.push_back(w);
+	}
+}
+
+Compiler::~Compiler()
+{
+	for (uint32_t i = 0; i < workers.size(); i++) {
+		delete workers[i]->solver;
+		delete workers[i]->oracle;
+		delete workers[i];
+	}
+	for (uint32_t i = 0; i < node_chunks.size(); i++) delete[] node_chunks[i].load();
+}
+
+void Compiler::set_ranks(const vector<uint32_t> & var_rank)
+{
+	// a variable without a rank, such as one of a group, takes the highest rank it
+	// shares a clause with, as it is decided once the variables of that rank are
+	for (uint32_t v = 1; v <= vars; v++)
+		rank[v] = (v < var_rank.size() && var_rank[v] != UINT32_MAX) ? var_rank[v] : 0;
+	for (uint32_t v = 1; v <= vars; v++) {
+		if (v < var_rank.size() && var_rank[v] != UINT32_MAX) continue;
+		for (uint32_t i = 0; i < occurrences[v].size(); i++) {
+			const vector<int32_t> & clause = clauses[occurrences[v][i]];
+			for (uint32_t j = 0; j < clause.size(); j++) {
+				uint32_t u = abs(clause[j]);
+				if (u < var_rank.size() && var_rank[u] != UINT32_MAX) rank[v] = max(rank[v], var_rank[u]);
+			}
+		}
+	}
+	by_shape = true;
+}
+
+bool Compiler::cache_lookup(CacheShard * shards, const vector<uint32_t> & key, CacheEntry & entry)
+{
+	CacheShard & shard = shards[KeyHash()(key) % COMPILER_CACHE_SHARDS];
+	lock_guard<mutex> lock(shard.mutex);
+	auto it = shard.entries.find(key);
+	if (it == shard.entries.end()) return false;
+	entry = it->second;
+	return true;
+}
+
+void Compiler::cache_insert(CacheShard * shards, const vector<uint32_t> & key, const CacheEntry & entry)
+{
+	CacheShard & shard = shards[KeyHash()(key) % COMPILER_CACHE_SHARDS];
+	lock_guard<mutex> lock(shard.mutex);
+	auto result = shard.entries.emplace(key, entry);
+	if (!result.second) return;
+	shard.order.push_back(&result.first->first);
+	shard.bytes += sizeof(uint32_t)*(key.size() + entry.vars.size()) + sizeof(*result.first) + 2*sizeof(void *);
+	while (shard.bytes > COMPILER_CACHE_BYTES/COMPILER_CACHE_SHARDS && shard.order.size() > 1) {
+		auto oldest = shard.entries.find(*shard.order.front());
+		shard.bytes -= sizeof(uint32_t)*(oldest->first.size() + oldest->second.vars.size()) + sizeof(*oldest) + 2*sizeof(void *);
+		shard.order.pop_front();
+		shard.entries.erase(oldest);
+	}
+}
+
+Compiler::StoredNode & Compiler::stored(uint32_t node)
+{
+	StoredNode * chunk = node_chunks[node >> COMPILER_NODE_CHUNK_BITS].load(memory_order_acquire);
+	return chunk[node & ((1 << COMPILER_NODE_CHUNK_BITS)-1)];
+}
+
+uint32_t Compiler::append_node(DDNNF::node_type type, int32_t literal, const vector<uint32_t> & node_children)
+{
+	uint32_t node = node_count.fetch_add(1, memory_order_relaxed);
+	atomic<StoredNode *> & chunk = node_chunks[node >> COMPILER_NODE_CHUNK_BITS];
+	StoredNode * nodes = chunk.load(memory_order_acquire);
+	if (!nodes) {
+		StoredNode * allocated = new StoredNode[1 << COMPILER_NODE_CHUNK_BITS];
+		if (chunk.compare_exchange_strong(nodes, allocated, memory_order_acq_rel)) {
+			nodes = allocated;
+		} else {
+			delete[] allocated;
+		}
+	}
+	StoredNode & record = nodes[node & ((1 << COMPILER_NODE_CHUNK_BITS)-1)];
+	record.type = type;
+	record.literal = literal;
+	record.children = node_children;
+	return node;
+}
+
+uint32_t Compiler::make_node(DDNNF::node_type type, int32_t literal, vector<uint32_t> & node_children)
+{
+	sort(node_children.begin(), node_children.end(), greater<uint32_t>());
+	size_t seed = node_children.size();
+	hash_combine(seed, (uint32_t)type);
+	hash_combine(seed, literal);
+	for (uint32_t i = 0; i < node_children.size(); i++) hash_combine(seed, node_children[i]);
+	// the shard is chosen by the low bits of the hash and the slot by the others,
+	// and a node is appended and indexed under the lock of its shard
+	NodeShard & shard = node_index[seed % COMPILER_NODE_SHARDS];
+	size_t position = seed / COMPILER_NODE_SHARDS;
+	lock_guard<mutex> lock(shard.mutex);
+	size_t mask = shard.slots.size()-1;
+	for (size_t probe = 0; ; probe++) {
+		pair<size_t, uint32_t> & slot = shard.slots[(position + probe) & mask];
+		if (!slot.second) break;
+		if (slot.first != seed) continue;
+		StoredNode & other = stored(slot.second-1);
+		if (other.type == type && other.literal == literal && other.children == node_children) return slot.second-1;
+	}
+	uint32_t node = append_node(type, literal, node_children);
+	if (2*(shard.used+1) > shard.slots.size()) {
+		vector<pair<size_t, uint32_t>> slots(2*shard.slots.size(), make_pair(0, 0));
+		mask = slots.size()-1;
+		for (uint32_t i = 0; i < shard.slots.size(); i++) {
+			if (!shard.slots[i].second) continue;
+			size_t j = shard.slots[i].first / COMPILER_NODE_SHARDS;
+			while (slots[j & mask].second) j++;
+			slots[j & mask] = shard.slots[i];
+		}
+		shard.slots.swap(slots);
+	}
+	size_t j = position;
+	while (shard.slots[j & mask].second) j++;
+	shard.slots[j & mask] = make_pair(seed, node+1);
+	shard.used++;
+	return node;
+}
+
+bool Compiler::satisfied(Worker & w, uint32_t c)
+{
+	for (uint32_t j = 0; j < clauses[c].size(); j++) {
+		if (w.solver->value(clauses[c][j]) > 0) return true;
+	}
+	return false;
+}
+
+bool Compiler::consistent(Worker & w)
+{
+	// the last model is reused while it agrees with every decision
+	bool agrees = !w.model.empty();
+	for (uint32_t i = 0; agrees && i < w.decisions.size(); i++) {
+		int32_t var = abs(w.decisions[i]);
+		agrees = (w.model[var-1] == (w.decisions[i] > 0));
+	}
+	if (agrees) return true;
+	for (uint32_t i = 0; i < w.decisions.size(); i++) w.oracle->assume(w.decisions[i]);
+	if (!w.oracle->solve()) return false;
+	w.model = w.oracle->assignment;
+	return true;
+}
+
+void Compiler::sync(Worker & w)
+{
+	uint32_t shared = 0;
+	while (shared < w.pushed.size() && shared < w.decisions.size() && w.pushed[shared] == w.decisions[shared])
+		shared++;
+	while (w.pushed.size() > shared) {
+		w.solver->pop();
+		w.pushed.pop_back();
+	}
+	while (w.pushed.size() < w.decisions.size()) {
+		int32_t lit = w.decisions[w.pushed.size()];
+		w.solver->push(lit);
+		w.pushed.push_back(lit);
+	}
+}
+
+Compiler::Task * Compiler::spawn(Worker & w, const Component & component, int32_t lit)
+{
+	Task * task = new Task();
+	task->component = component;
+	task->decisions = w.decisions;
+	task->lit = lit;
+	task->result = false_node;
+	{
+		lock_guard<mutex> lock(w.mutex);
+		w.tasks.push_back(task);
+		pending++;
+	}
+	wake(false);
+	return task;
+}
+
+Compiler::Task * Compiler::take(Worker & w)
+{
+	// the newest own task, or else the oldest task of another thread
+	{
+		lock_guard<mutex> lock(w.mutex);
+		if (!w.tasks.empty()) {
+			Task * task = w.tasks.back();
+			w.tasks.pop_back();
+			pending--;
+			return task;
+		}
+	}
+	for (uint32_t i = 1; i < workers.size(); i++) {
+		Worker & other = *workers[(w.index + i) % workers.size()];
+		lock_guard<mutex> lock(other.mutex);
+		if (!other.tasks.empty()) {
+			Task * task = other.tasks.front();
+			other.tasks.pop_front();
+			pending--;
+			return task;
+		}
+	}
+	return NULL;
+}
+
+void Compiler::wake(bool all)
+{
+	// the lock orders the change a sleeper waits for before its check of it
+	{
+		lock_guard<mutex> lock(sleep_mutex);
+	}
+	if (all) wakeup.notify_all();
+	else wakeup.notify_one();
+}
+
+void Compiler::run(Worker & w, Task * task)
+{
+	// the solvers are left on the path of the task, until the interrupted one resumes and syncs
+	vector<int32_t> interrupted;
+	interrupted.swap(w.decisions);
+	w.decisions.swap(task->decisions);
+	sync(w);
+	task->result = (task->lit ? branch(w, task->component, task->lit) : compile(w, task->component));
+	w.decisions.swap(interrupted);
+	task->done.store(true, memory_order_release);
+	wake(true);
+}
+
+void Compiler::wait(Worker & w, Task * task)
+{
+	bool waiting = false;
+	while (!task->done.load(memory_order_acquire)) {
+		Task * other = take(w);
+		if (other) {
+			if (waiting) idle--;
+			waiting = false;
+			run(w, other);
+		} else {
+			if (!waiting) idle++;
+			waiting = true;
+			unique_lock<mutex> lock(sleep_mutex);
+			wakeup.wait(lock, [&] { return task->done.load(memory_order_acquire) || pending.load() > 0; });
+		}
+	}
+	if (waiting) idle--;
+	sync(w);
+}
+
+void Compiler::work(Worker & w)
+{
+	idle++;
+	while (!finished.load(memory_order_acquire)) {
+		Task * task = take(w);
+		if (task) {
+			idle--;
+			run(w, task);
+			idle++;
+		} else {
+			unique_lock<mutex> lock(sleep_mutex);
+			wakeup.wait(lock, [this] { return finished.load(memory_order_acquire) || pending.load() > 0; });
+		}
+	}
+	idle--;
+}
+
+void Compiler::components(Worker & w, const vector<uint32_t> & component_vars, const vector<uint32_t> & component_clauses, vector<Component> & out)
+{
+	// connected components of the unassigned variables through the unsatisfied clauses
+	w.stamp++;
+	for (uint32_t i = 0; i < component_clauses.size(); i++) w.clause_in[component_clauses[i]] = w.stamp;
+	for (uint32_t i = 0; i < component_vars.size(); i++) w.var_in[component_vars[i]] = w.stamp;
+	for (uint32_t i = 0; i < component_vars.size(); i++) {
+		uint32_t v = component_vars[i];
+		if (w.var_seen[v] == w.stamp || w.solver->value(v)) continue;
+		Component part;
+		part.vars.push_back(v);
+		w.var_seen[v] = w.stamp;
+		for (uint32_t k = 0; k < part.vars.size(); k++) {
+			const vector<uint32_t> & occ = occurrences[part.vars[k]];
+			for (uint32_t j = 0; j < occ.size(); j++) {
+				uint32_t c = occ[j];
+				if (w.clause_in[c] != w.stamp || w.clause_seen[c] == w.stamp) continue;
+				w.clause_seen[c] = w.stamp;
+				if (satisfied(w, c)) continue;
+				part.clauses.push_back(c);
+				for (uint32_t l = 0; l < clauses[c].size(); l++) {
+					uint32_t u = abs(clauses[c][l]);
+					if (w.var_in[u] != w.stamp || w.var_seen[u] == w.stamp || w.solver->value(u)) continue;
+					w.var_seen[u] = w.stamp;
+					part.vars.push_back(u);
+				}
+			}
+		}
+		// a variable in no unsatisfied clause is free, and left out of the circuit
+		if (part.clauses.empty()) continue;
+		sort(part.vars.begin(), part.vars.end());
+		sort(part.clauses.begin(), part.clauses.end());
+		out.push_back(part);
+	}
+}
+
+uint32_t Compiler::conjoin(Worker & w, uint32_t trail_begin, vector<Component> & parts)
+{
+	// the literals assigned since trail_begin, and the components of what is left,
+	// which are all satisfiable if the residual formula is
+	if (!consistent(w)) return false_node;
+	vector<uint32_t> node_children, none;
+	for (uint32_t i = trail_begin; i < w.solver->trail_size(); i++)
+		node_children.push_back(make_node(DDNNF::LITERAL, w.solver->trail_lit(i), none));
+	// components beyond the first are left to idle threads
+	vector<Task *> spawned;
+	bool conflict = false;
+	for (uint32_t i = 0; i < parts.size() && !conflict; i++) {
+		if (i > 0 && idle.load(memory_order_relaxed) > 0 && parts[i].vars.size() >= COMPILER_MIN_TASK_VARS) {
+			spawned.push_back(spawn(w, parts[i], 0));
+			continue;
+		}
+		uint32_t node = compile(w, parts[i]);
+		if (node == false_node) conflict = true;
+		node_children.push_back(node);
+	}
+	for (uint32_t i = 0; i < spawned.size(); i++) {
+		wait(w, spawned[i]);
+		if (spawned[i]->result == false_node) conflict = true;
+		node_children.push_back(spawned[i]->result);
+		delete spawned[i];
+	}
+	if (conflict) return false_node;
+	if (node_children.empty()) return true_node;
+	if (node_children.size() == 1) return node_children[0];
+	return make_node(DDNNF::AND, 0, node_children);
+}
+
+uint32_t Compiler::branch(Worker & w, const Component & component, int32_t lit)
+{
+	uint32_t begin = w.solver->trail_size();
+	uint32_t node = false_node;
+	w.decisions.push_back(lit);
+	w.pushed.push_back(lit);
+	if (w.solver->push(lit)) {
+		vector<Component> parts;
+		components(w, component.vars, component.clauses, parts);
+		node = conjoin(w, begin, parts);
+	}
+	w.decisions.pop_back();
+	w.pushed.pop_back();
+	w.solver->pop();
+	return node;
+}
+
+void Compiler::shape(Worker & w, const Component & component, vector<uint32_t> & key)
+{
+	// the residual clauses over the positions of the variables, in sorted order,
+	// which are equal for two components if renaming one to the other maps the clauses
+	for (uint32_t i = 0; i < component.vars.size(); i++) w.local[component.vars[i]] = i;
+	vector<vector<uint32_t>> residual(component.clauses.size());
+	for (uint32_t i = 0; i < component.clauses.size(); i++) {
+		const vector<int32_t> & clause = clauses[component.clauses[i]];
+		for (uint32_t j = 0; j < clause.size(); j++) {
+			if (!w.solver->value(clause[j])) residual[i].push_back(2*w.local[abs(clause[j])] + (clause[j] < 0));
+		}
+		sort(residual[i].begin(), residual[i].end());
+	}
+	sort(residual.begin(), residual.end());
+	key.assign(1, component.vars.size());
+	for (uint32_t i = 0; i < residual.size(); i++) {
+		key.insert(key.end(), residual[i].begin(), residual[i].end());
+		key.push_back(UINT32_MAX);
+	}
+}
+
+uint32_t Compiler::instantiate(uint32_t node, unordered_map<uint32_t, uint32_t> & rename, unordered_map<uint32_t, uint32_t> & copies)
+{
+	if (node == false_node || node == true_node) return node;
+	auto it = copies.find(node);
+	if (it != copies.end()) return it->second;
+	const StoredNode & original = stored(node);
+	vector<uint32_t> node_children(original.children.size());
+	for (uint32_t i = 0; i < original.children.size(); i++)
+		node_children[i] = instantiate(original.children[i], rename, copies);
+	int32_t literal = original.literal;
+	if (literal) {
+		int32_t var = rename.at(abs(literal));
+		literal = (literal > 0) ? var : -var;
+	}
+	uint32_t copy = make_node(original.type, literal, node_children);
+	copies[node] = copy;
+	return copy;
+}
+
+uint32_t Compiler::compile(Worker & w, const Component & component)
+{
+	vector<uint32_t> key(component.vars);
+	key.push_back(UINT32_MAX);
+	key.insert(key.end(), component.clauses.begin(), component.clauses.end());
+	CacheEntry entry;
+	if (cache_lookup(cache, key, entry)) return entry.node;
+	vector<uint32_t> shape_key;
+	if (by_shape) {
+		shape(w, component, shape_key);
+		if (cache_lookup(shape_cache, shape_key, entry)) {
+			unordered_map<uint32_t, uint32_t> rename, copies;
+			for (uint32_t i = 0; i < component.vars.size(); i++) rename[entry.vars[i]] = component.vars[i];
+			entry.node = instantiate(entry.node, rename, copies);
+			entry.vars.clear();
+			cache_insert(cache, key, entry);
+			return entry.node;
+		}
+	}
+
+	// branch on the variable of the lowest rank in most unsatisfied clauses of the component
+	for (uint32_t i = 0; i < component.clauses.size(); i++) {
+		const vector<int32_t> & clause = clauses[component.clauses[i]];
+		for (uint32_t j = 0; j < clause.size(); j++) {
+			if (!w.solver->value(clause[j])) w.score[abs(clause[j])]++;
+		}
+	}
+	uint32_t best = component.vars[0];
+	for (uint32_t i = 0; i < component.vars.size(); i++) {
+		uint32_t v = component.vars[i];
+		if (rank[v] < rank[best] || (rank[v] == rank[best] && w.score[v] > w.score[best])) best = v;
+	}
+	for (uint32_t i = 0; i < component.vars.size(); i++) w.score[component.vars[i]] = 0;
+
+	// the negative branch is left to an idle thread
+	Task * task = NULL;
+	if (idle.load(memory_order_relaxed) > 0 && component.vars.size() >= COMPILER_MIN_TASK_VARS)
+		task = spawn(w, component, -(int32_t)best);
+	uint32_t result = false_node;
+	vector<uint32_t> branches;
+	uint32_t positive = branch(w, component, best);
+	if (positive != false_node) branches.push_back(positive);
+	uint32_t negative;
+	if (task) {
+		wait(w, task);
+		negative = task->result;
+		delete task;
+	} else {
+		negative = branch(w, component, -(int32_t)best);
+	}
+	if (negative != false_node) branches.push_back(negative);
+	if (branches.size() == 1) result = branches[0];
+	else if (branches.size() == 2) result = make_node(DDNNF::OR, best, branches);
+	entry.node = result;
+	cache_insert(cache, key, entry);
+	if (by_shape) {
+		entry.vars = component.vars;
+		cache_insert(shape_cache, shape_key, entry);
+	}
+	return result;
+}
+
+void Compiler::compile(DDNNF & out)
+{
+	Worker & w = *workers[0];
+	vector<uint32_t> none;
+	false_node = make_node(DDNNF::OR, 0, none);
+	true_node = make_node(DDNNF::AND, 0, none);
+	vector<thread> threads;
+	for (uint32_t i = 1; i < workers.size(); i++)
+		threads.emplace_back(&Compiler::work, this, ref(*workers[i]));
+	uint32_t root = false_node;
+	if (!root_conflict) {
+		Component all;
+		for (uint32_t v = 1; v <= vars; v++) all.vars.push_back(v);
+		for (uint32_t c = 0; c < clauses.size(); c++) all.clauses.push_back(c);
+		vector<Component> parts;
+		components(w, all.vars, all.clauses, parts);
+		root = conjoin(w, 0, parts);
+	}
+	finished.store(true, memory_order_release);
+	wake(true);
+	for (uint32_t i = 0; i < threads.size(); i++) threads[i].join();
+
+	out.clear(vars);
+	for (uint32_t i = 0; i < node_count.load(); i++) {
+		StoredNode & node = stored(i);
+		out.add_node(node.type, node.literal, node.children);
+	}
+	vector<uint32_t> root_children(1, root);
+	out.add_node(DDNNF::AND, 0, root_children);
+	out.finish();
+}
+
+static void scc_order(const DynamicAF & af, vector<uint32_t> & scc)
+{
+	// Tarjan's algorithm along attackers, so that the SCC of an argument is
+	// numbered after the SCCs of its attackers
+	const uint32_t none = UINT32_MAX;
+	vector<uint32_t> index(af.args, none), low(af.args), stack;
+	vector<uint8_t> on_stack(af.args);
+	vector<pair<uint32_t,uint32_t>> calls;
+	uint32_t next_index = 0, next_scc = 0;
+	scc.assign(af.args, none);
+	for (uint32_t root = 0; root < af.args; root++) {
+		if (index[root] != none) continue;
+		calls.push_back(make_pair(root, 0));
+		index[root] = low[root] = next_index++;
+		stack.push_back(root);
+		on_stack[root] = true;
+		while (!calls.empty()) {
+			uint32_t a = calls.back().first;
+			uint32_t & i = calls.back().second;
+			if (i < af.attackers[a].size()) {
+				uint32_t b = af.attackers[a][i++];
+				if (index[b] == none) {
+					index[b] = low[b] = next_index++;
+					stack.push_back(b);
+					on_stack[b] = true;
+					calls.push_back(make_pair(b, 0));
+				} else if (on_stack[b]) {
+					low[a] = min(low[a], index[b]);
+				}
+				continue;
+			}
+			calls.pop_back();
+			if (!calls.empty()) low[calls.back().first] = min(low[calls.back().first], low[a]);
+			if (low[a] != index[a]) continue;
+			uint32_t b;
+			do {
+				b = stack.back();
+				stack.pop_back();
+				on_stack[b] = false;
+				scc[b] = next_scc;
+			} while (b != a);
+			next_scc++;
+		}
+	}
+}
+
+static void rename_vars(vector<vector<int32_t>> & clauses, const vector<uint32_t> & renamed)
+{
+	for (uint32_t i = 0; i < clauses.size(); i++) {
+		for (uint32_t j = 0; j < clauses[i].size(); j++) {
+			int32_t var = renamed[abs(clauses[i][j])];
+			clauses[i][j] = (clauses[i][j] > 0) ? var : -var;
+		}
+	}
+}
+
+static void rename_ranks(vector<uint32_t> & var_rank, const vector<uint32_t> & renamed, uint32_t n_vars)
+{
+	vector<uint32_t> renamed_rank(n_vars+1, UINT32_MAX);
+	for (uint32_t v = 1; v < renamed.size() && v < var_rank.size(); v++) {
+		if (renamed[v]) renamed_rank[renamed[v]] = var_rank[v];
+	}
+	var_rank.swap(renamed_rank);
+}
+
+bool Compiler::compile(const DynamicAF & af, DDNNF & out, uint32_t n_threads, bool by_scc,
+	const vector<pair<int32_t,int32_t>> & dynamic_attacks)
+{
+	if (af.sem != AD && af.sem != CO && af.sem != ST) return false;
+	// with dynamic attacks, the encoding is the one of the dynamic mode, where
+	// every pair of arguments has an attack variable, fixed for all the other pairs
+	DynamicAF structure(af);
+	if (!dynamic_attacks.empty()) {
+		structure.static_mode = false;
+		structure.dense = false;
+		structure.set_var_count();
+	}
+	vector<vector<int32_t>> encoding;
+	SAT_Solver solver(structure.count, 2*structure.args);
+	solver.clause_log = &encoding;
+	if (structure.sem == AD) {
+		Encodings::add_admissible(structure, &solver);
+	} else if (structure.sem == CO) {
+		Encodings::add_complete(structure, &solver);
+	} else {
+		Encodings::add_stable(structure, &solver);
+	}
+	solver.clause_log = NULL;
+	uint32_t n_frozen = af.args, n_vars = 0;
+	vector<uint32_t> moved;
+	if (!dynamic_attacks.empty()) {
+		vector<uint8_t> dynamic(af.args*af.args);
+		for (uint32_t k = 0; k < dynamic_attacks.size(); k++) {
+			dynamic[af.args*dynamic_attacks[k].first + dynamic_attacks[k].second] = true;
+		}
+		for (uint32_t i = 0; i < af.args; i++) {
+			encoding.push_back(vector<int32_t>(1, af.arg_exists[i] ? structure.arg_exists_var(i) : -structure.arg_exists_var(i)));
+			for (uint32_t j = 0; j < af.args; j++) {
+				if (dynamic[af.args*i+j]) continue;
+				int32_t var = structure.att_exists_var(i, j);
+				encoding.push_back(vector<int32_t>(1, af.attacks.count(make_pair(i, j)) ? var : -var));
+			}
+		}
+		// the selectors of the dynamic attacks are numbered right after the
+		// accepted variables, in their given order, and the other variables
+		// of the clauses after them, leaving out the unused ones of the encoding
+		moved.assign(structure.count+1, 0);
+		for (uint32_t k = 0; k < dynamic_attacks.size(); k++) {
+			moved[structure.att_exists_var(dynamic_attacks[k].first, dynamic_attacks[k].second)] = af.args+k+1;
+		}
+		uint32_t next_var = af.args+dynamic_attacks.size();
+		for (uint32_t v = 1; v <= af.args; v++) moved[v] = v;
+		for (uint32_t i = 0; i < encoding.size(); i++) {
+			for (uint32_t j = 0; j < encoding[i].size(); j++) {
+				uint32_t var = abs(encoding[i][j]);
+				if (!moved[var]) moved[var] = ++next_var;
+			}
+		}
+		rename_vars(encoding, moved);
+		n_frozen = n_vars = af.args+dynamic_attacks.size();
+	}
+	vector<uint32_t> renamed;
+#if defined(PREPROCESS_CNF)
+	// the accepted variables 1..af.args and the selectors are the projection, and keep their numbers
+	Preprocessor preprocessor(encoding, n_frozen);
+	n_vars = preprocessor.simplify();
+	renamed.swap(preprocessor.renamed);
+#endif
+	Compiler compiler(encoding, n_threads, n_vars);
+	if (by_scc) {
+		vector<uint32_t> scc, var_rank(structure.count+1, UINT32_MAX);
+		scc_order(af, scc);
+		for (uint32_t i = 0; i < af.args; i++) {
+			if (!af.arg_exists[i]) continue;
+			var_rank[structure.accepted_var(i)] = var_rank[structure.rejected_var(i)] = scc[i];
+		}
+		if (!moved.empty()) rename_ranks(var_rank, moved, structure.count);
+		if (!renamed.empty()) rename_ranks(var_rank, renamed, n_vars);
+		compiler.set_ranks(var_rank);
+	}
+	compiler.compile(out);
+	return true;
+}
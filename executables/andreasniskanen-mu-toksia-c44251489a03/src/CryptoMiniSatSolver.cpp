@@ -28,6 +28,9 @@
 
 #include "CryptoMiniSatSolver.h"
 
+#include <algorithm>
+#include <limits>
+
 using namespace std;
 using namespace CMSat;
 
@@ -36,6 +39,12 @@ CryptoMiniSatSolver::CryptoMiniSatSolver(int32_t n_vars, int32_t n_args)
 	solver.set_num_threads(1);
 	solver.new_vars(n_vars);
 	decision_vars = n_args;
+	conflict_limit = -1;
+	propagation_limit = -1;
+	timed = false;
+	interrupted = false;
+	qhead = 0;
+	stale = false;
 	//solver.set_no_simplify();
 	//solver.set_no_equivalent_lit_replacement();
 	//solver.set_no_bva();
@@ -44,6 +53,7 @@ CryptoMiniSatSolver::CryptoMiniSatSolver(int32_t n_vars, int32_t n_args)
 
 void CryptoMiniSatSolver::add_clause(const vector<int32_t> & clause)
 {
+	if (clause_log) clause_log->push_back(clause);
 	vector<Lit> lits(clause.size());
 	for (uint32_t i = 0; i < clause.size(); i++) {
 		int32_t var = abs(clause[i])-1;
@@ -52,6 +62,32 @@ void CryptoMiniSatSolver::add_clause(const vector<int32_t> & clause)
 		lits[i] = Lit(var, clause[i] < 0);
 	}
 	solver.add_clause(lits);
+	attach(lits);
+}
+
+void CryptoMiniSatSolver::attach(vector<Lit> & lits)
+{
+	if (watches.size() < 2*solver.nVars()) watches.resize(2*solver.nVars());
+	sort(lits.begin(), lits.end());
+	lits.erase(unique(lits.begin(), lits.end()), lits.end());
+	for (uint32_t i = 1; i < lits.size(); i++) {
+		if (lits[i] == ~lits[i-1]) return;
+	}
+	// a clause added while levels are pushed is watched by literals that are not false,
+	// and if it has fewer than two of them, the levels are assigned anew at the next push
+	uint32_t watched = 0;
+	for (uint32_t i = 0; i < lits.size() && watched < 2; i++) {
+		if (lit_value(lits[i]) >= 0) swap(lits[i], lits[watched++]);
+	}
+	if (watched < 2 && !trail_lim.empty()) stale = true;
+	if (lits.size() < 2) {
+		units.insert(units.end(), lits.begin(), lits.end());
+		if (lits.empty()) units.push_back(lit_Undef);
+		return;
+	}
+	watches[lits[0].toInt()].push_back(clauses.size());
+	watches[lits[1].toInt()].push_back(clauses.size());
+	clauses.push_back(lits);
 }
 
 void CryptoMiniSatSolver::assume(int32_t lit)
@@ -62,13 +98,49 @@ void CryptoMiniSatSolver::assume(int32_t lit)
 	assumptions.push_back(Lit(var, lit < 0));
 }
 
+bool CryptoMiniSatSolver::exhausted()
+{
+	return interrupted
+		|| (conflict_limit >= 0 && solver.get_sum_conflicts() >= (uint64_t)conflict_limit)
+		|| (propagation_limit >= 0 && solver.get_sum_propagations() >= (uint64_t)propagation_limit)
+		|| (timed && chrono::steady_clock::now() >= deadline);
+}
+
 bool CryptoMiniSatSolver::solve()
 {
-	bool sat = solver.solve(&assumptions) == l_True;
+	// CryptoMiniSat measures its own time limit in CPU time and has no propagation
+	// limit, so both are enforced between slices of conflicts
+	lbool result = l_Undef;
+	while (!exhausted()) {
+		uint64_t budget = numeric_limits<uint64_t>::max();
+		if (conflict_limit >= 0)
+			budget = conflict_limit - solver.get_sum_conflicts();
+		if ((timed || propagation_limit >= 0) && budget > SOLVE_SLICE_CONFLICTS)
+			budget = SOLVE_SLICE_CONFLICTS;
+		solver.set_max_confl(budget);
+		result = solver.solve(&assumptions);
+		if (result == l_True && refine && refine()) {
+			result = l_Undef;
+			continue;
+		}
+		if (result == l_True) model = solver.get_model();
+		if (result != l_Undef) break;
+	}
+	if (result == l_Undef) {
+		assumptions.clear();
+		throw SolveInterrupted();
+	}
+	bool sat = (result == l_True);
 	if (sat) {
 		assignment.clear();
 		for (int32_t i = 0; i < decision_vars; i++)
-			assignment.push_back(solver.get_model()[i] == l_True ? 1 : 0);
+			assignment.push_back(model[i] == l_True ? 1 : 0);
+	} else {
+		core.clear();
+		for (const Lit & lit : solver.get_conflict()) {
+			int32_t var = lit.var()+1;
+			core.push_back(lit.sign() ? var : -var);
+		}
 	}
 	assumptions.clear();
 	return sat;
@@ -97,6 +169,165 @@ bool CryptoMiniSatSolver::propagate(vector<int32_t> & out_lits)
 bool CryptoMiniSatSolver::get_value(int32_t lit)
 {
 	int32_t var = abs(lit)-1;
-	lbool val = solver.get_model()[var];
+	lbool val = model[var];
 	return (lit > 0) ? val == l_True : val == l_False;
-}
\ No newline at end of file
+}
+void CryptoMiniSatSolver::simplify()
+{
+	solver.simplify();
+}
+
+void CryptoMiniSatSolver::set_phase(int32_t lit)
+{
+	// no-op: CryptoMiniSat only exposes a global polarity mode, so the hint is dropped
+}
+
+void CryptoMiniSatSolver::set_activity(int32_t var, double activity)
+{
+	// no-op: CryptoMiniSat does not expose variable activities, so the hint is dropped
+}
+
+void CryptoMiniSatSolver::set_limits(int64_t conflicts, int64_t propagations, double seconds)
+{
+	interrupted = false;
+	conflict_limit = (conflicts < 0 ? -1 : solver.get_sum_conflicts() + conflicts);
+	propagation_limit = (propagations < 0 ? -1 : solver.get_sum_propagations() + propagations);
+	timed = (seconds >= 0);
+	if (timed) {
+		deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+	}
+}
+
+void CryptoMiniSatSolver::interrupt()
+{
+	interrupted = true;
+	solver.interrupt_asap();
+}
+
+int8_t CryptoMiniSatSolver::lit_value(Lit lit)
+{
+	if (lit.var() >= values.size()) return 0;
+	return lit.sign() ? -values[lit.var()] : values[lit.var()];
+}
+
+bool CryptoMiniSatSolver::assign(Lit lit)
+{
+	if (lit == lit_Undef) return false;
+	if (lit.var() >= values.size()) values.resize(lit.var()+1, 0);
+	int8_t val = lit.sign() ? -1 : 1;
+	if (values[lit.var()] == -val) return false;
+	if (values[lit.var()] == 0) {
+		values[lit.var()] = val;
+		trail.push_back(lit);
+	}
+	return true;
+}
+
+bool CryptoMiniSatSolver::propagate_trail()
+{
+	// CryptoMiniSat only propagates a whole set of assumptions at once, so the
+	// wrapper propagates its own copy of the clauses from the new literals on
+	while (qhead < trail.size()) {
+		Lit p = trail[qhead++];
+		vector<uint32_t> & ws = watches[(~p).toInt()];
+		uint32_t i, j;
+		for (i = j = 0; i < ws.size(); i++) {
+			vector<Lit> & c = clauses[ws[i]];
+			if (c[0] == ~p) swap(c[0], c[1]);
+			if (lit_value(c[0]) > 0) {
+				ws[j++] = ws[i];
+				continue;
+			}
+			uint32_t k = 2;
+			while (k < c.size() && lit_value(c[k]) < 0) k++;
+			if (k < c.size()) {
+				swap(c[1], c[k]);
+				watches[c[1].toInt()].push_back(ws[i]);
+				continue;
+			}
+			ws[j++] = ws[i];
+			if (!assign(c[0])) {
+				for (i++; i < ws.size(); i++) ws[j++] = ws[i];
+				ws.resize(j);
+				return false;
+			}
+		}
+		ws.resize(j);
+	}
+	return true;
+}
+
+bool CryptoMiniSatSolver::repropagate()
+{
+	for (const Lit & p : trail) values[p.var()] = 0;
+	trail.clear();
+	qhead = 0;
+	for (uint32_t level = 0; level < pushed.size(); level++) {
+		trail_lim[level] = trail.size();
+		bool ok = true;
+		for (uint32_t i = 0; ok && level == 0 && i < units.size(); i++) ok = assign(units[i]);
+		if (ok && pushed[level] != lit_Undef) ok = assign(pushed[level]);
+		if (!ok || !propagate_trail()) return false;
+	}
+	stale = false;
+	return true;
+}
+
+bool CryptoMiniSatSolver::push(int32_t lit)
+{
+	// the first level also holds the consequences of the unit clauses
+	trail_lim.push_back(trail.size());
+	pushed.push_back(lit_Undef);
+	if (lit) {
+		int32_t var = abs(lit)-1;
+		while ((uint32_t)var >= solver.nVars())
+			solver.new_var();
+		pushed.back() = Lit(var, lit < 0);
+		if (watches.size() < 2*solver.nVars()) watches.resize(2*solver.nVars());
+	}
+	if (stale) return repropagate();
+	for (uint32_t i = 0; trail_lim.size() == 1 && i < units.size(); i++) {
+		if (!assign(units[i])) return false;
+	}
+	if (pushed.back() != lit_Undef && !assign(pushed.back())) return false;
+	return propagate_trail();
+}
+
+void CryptoMiniSatSolver::pop()
+{
+	while (trail.size() > trail_lim.back()) {
+		values[trail.back().var()] = 0;
+		trail.pop_back();
+	}
+	qhead = trail.size();
+	trail_lim.pop_back();
+	pushed.pop_back();
+}
+
+int8_t CryptoMiniSatSolver::value(int32_t lit)
+{
+	uint32_t var = abs(lit)-1;
+	if (var >= values.size()) return 0;
+	return (lit > 0) ? values[var] : -values[var];
+}
+
+uint32_t CryptoMiniSatSolver::trail_size()
+{
+	return trail.size();
+}
+
+int32_t CryptoMiniSatSolver::trail_lit(uint32_t i)
+{
+	return trail[i].sign() ? -(int32_t)(trail[i].var()+1) : trail[i].var()+1;
+}
+
+uint64_t CryptoMiniSatSolver::reserved_bytes()
+{
+	// CryptoMiniSat does not report the size of its clause database
+	return 0;
+}
+
+bool CryptoMiniSatSolver::huge_pages()
+{
+	return false;
+}
@@ -0,0 +1,1037 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "DDNNF.h"
+
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <random>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// arbitrary precision model counts, in 32-bit limbs with the least significant first
+typedef vector<uint32_t> Natural;
+
+static Natural power_of_two(uint32_t k)
+{
+	Natural n(k/32+1, 0);
+	n.back() = 1U << (k%32);
+	return n;
+}
+
+static void add(Natural & a, const Natural & b)
+{
+	if (a.size() < b.size()) a.resize(b.size(), 0);
+	uint64_t carry = 0;
+	for (uint32_t i = 0; i < a.size(); i++) {
+		carry += (uint64_t)a[i] + (i < b.size() ? b[i] : 0);
+		a[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	if (carry) a.push_back(carry);
+}
+
+static Natural multiply_shift(const Natural & a, const Natural & b, uint32_t k)
+{
+	// a*b / 2^k, where the division is known to be exact
+	Natural product(a.size()+b.size(), 0);
+	for (uint32_t i = 0; i < a.size(); i++) {
+		uint64_t carry = 0;
+		if (!a[i]) continue;
+		for (uint32_t j = 0; j < b.size(); j++) {
+			carry += (uint64_t)a[i]*b[j] + product[i+j];
+			product[i+j] = (uint32_t)carry;
+			carry >>= 32;
+		}
+		product[i+b.size()] = carry;
+	}
+	Natural result;
+	uint32_t words = k/32, bits = k%32;
+	for (uint32_t i = words; i < product.size(); i++) {
+		uint64_t next = (i+1 < product.size() ? product[i+1] : 0);
+		result.push_back(bits ? (uint32_t)((product[i] >> bits) | (next << (32-bits))) : product[i]);
+	}
+	while (!result.empty() && !result.back()) result.pop_back();
+	return result;
+}
+
+static bool smaller(const Natural & a, const Natural & b)
+{
+	uint32_t a_size = a.size(), b_size = b.size();
+	while (a_size && !a[a_size-1]) a_size--;
+	while (b_size && !b[b_size-1]) b_size--;
+	if (a_size != b_size) return a_size < b_size;
+	for (int32_t i = a_size-1; i >= 0; i--) {
+		if (a[i] != b[i]) return a[i] < b[i];
+	}
+	return false;
+}
+
+static void subtract(Natural & a, const Natural & b)
+{
+	// a-b, where a is known to be at least b
+	int64_t borrow = 0;
+	for (uint32_t i = 0; i < a.size(); i++) {
+		borrow += (int64_t)a[i] - (i < b.size() ? b[i] : 0);
+		a[i] = (uint32_t)borrow;
+		borrow = (borrow < 0 ? -1 : 0);
+	}
+	while (!a.empty() && !a.back()) a.pop_back();
+}
+
+static Natural random_below(const Natural & n, mt19937 & rng)
+{
+	// uniform by rejection from the numbers of the same bit length as n
+	uint32_t size = n.size();
+	while (size && !n[size-1]) size--;
+	uint32_t top = n[size-1], mask = 0;
+	while (mask < top) mask = (mask << 1) | 1;
+	Natural r(size);
+	do {
+		for (uint32_t i = 0; i < size; i++) r[i] = rng();
+		r[size-1] &= mask;
+	} while (!smaller(r, n));
+	return r;
+}
+
+static string to_string(Natural n)
+{
+	while (!n.empty() && !n.back()) n.pop_back();
+	if (n.empty()) return "0";
+	vector<uint32_t> digits;
+	while (!n.empty()) {
+		uint64_t rem = 0;
+		for (int32_t i = n.size()-1; i >= 0; i--) {
+			uint64_t cur = (rem << 32) | n[i];
+			n[i] = cur / 1000000000;
+			rem = cur % 1000000000;
+		}
+		digits.push_back(rem);
+		while (!n.empty() && !n.back()) n.pop_back();
+	}
+	string s = std::to_string(digits.back());
+	for (int32_t i = digits.size()-2; i >= 0; i--) {
+		string part = std::to_string(digits[i]);
+		s += string(9-part.size(), '0') + part;
+	}
+	return s;
+}
+
+struct Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t vars;
+	uint64_t nodes;
+	uint64_t leaves;
+	uint64_t child_bytes;
+};
+
+DDNNF::DDNNF() : vars(0), mapping(NULL), mapping_size(0), enumerating(false)
+{
+	finish();
+}
+
+DDNNF::~DDNNF()
+{
+	unmap();
+}
+
+void DDNNF::attach()
+{
+	n_nodes = node_storage.size();
+	nodes = node_storage.data();
+	child_data = child_storage.data();
+	literal_begin = literal_begin_storage.data();
+	literal_leaves = literal_leaf_storage.data();
+	sat.assign(size(), 0);
+	visited.clear();
+	evaluated = false;
+	enumerating = false;
+}
+
+void DDNNF::unmap()
+{
+	if (mapping) munmap(mapping, mapping_size);
+	mapping = NULL;
+	mapping_size = 0;
+}
+
+void DDNNF::index_literals()
+{
+	literal_begin_storage.assign(2*vars+3, 0);
+	for (uint32_t i = 0; i+1 < node_storage.size(); i++) {
+		if (node_storage[i].type == LITERAL)
+			literal_begin_storage[literal_index(node_storage[i].literal)+1]++;
+	}
+	for (uint32_t l = 1; l < literal_begin_storage.size(); l++)
+		literal_begin_storage[l] += literal_begin_storage[l-1];
+	literal_leaf_storage.resize(literal_begin_storage.back());
+	vector<uint64_t> next(literal_begin_storage);
+	for (uint32_t i = 0; i+1 < node_storage.size(); i++) {
+		if (node_storage[i].type == LITERAL)
+			literal_leaf_storage[next[literal_index(node_storage[i].literal)]++] = i;
+	}
+}
+
+static bool read_int(const char *& p, const char * end, int64_t & x)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+	bool negative = (p < end && *p == '-');
+	if (negative) p++;
+	if (p == end || *p < '0' || *p > '9') return false;
+	x = 0;
+	while (p < end && *p >= '0' && *p <= '9') x = 10*x + (*p++ - '0');
+	if (negative) x = -x;
+	return true;
+}
+
+bool DDNNF::load(const string & path)
+{
+	FILE * file = fopen(path.c_str(), "rb");
+	if (!file) return false;
+	char magic[8];
+	bool binary = (fread(magic, 1, 8, file) == 8 && memcmp(magic, DDNNF_MAGIC, 8) == 0);
+	fclose(file);
+	clear(0);
+	bool ok = (binary ? map(path) : parse(path));
+	if (!ok) {
+		clear(0);
+		finish();
+	}
+	return ok;
+}
+
+void DDNNF::clear(uint32_t n_vars)
+{
+	unmap();
+	node_storage.clear();
+	child_storage.clear();
+	vars = n_vars;
+}
+
+uint32_t DDNNF::add_node(node_type type, int32_t literal, vector<uint32_t> & node_children)
+{
+	uint32_t i = node_storage.size();
+	node_storage.push_back({ child_storage.size(), literal, type });
+	if (type == LITERAL) vars = max<uint32_t>(vars, abs(literal));
+	sort(node_children.begin(), node_children.end(), greater<uint32_t>());
+	uint32_t last = i;
+	for (uint32_t j = 0; j < node_children.size(); j++) {
+		for (uint32_t gap = last - node_children[j]; ; gap >>= 7) {
+			child_storage.push_back((gap & 127) | (gap >= 128 ? 128 : 0));
+			if (gap < 128) break;
+		}
+		last = node_children[j];
+	}
+	return i;
+}
+
+void DDNNF::finish()
+{
+	// an empty circuit stands for an unsatisfiable formula
+	if (node_storage.empty()) node_storage.push_back({ 0, 0, OR });
+	node_storage.push_back({ child_storage.size(), 0, OR });
+	node_storage.shrink_to_fit();
+	child_storage.shrink_to_fit();
+	index_literals();
+	attach();
+}
+
+bool DDNNF::parse(const string & path)
+{
+	FILE * file = fopen(path.c_str(), "rb");
+	if (!file) return false;
+	vector<char> buffer;
+	char chunk[1 << 16];
+	size_t n;
+	while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		buffer.insert(buffer.end(), chunk, chunk+n);
+	fclose(file);
+
+	const char * p = buffer.data();
+	const char * end = p + buffer.size();
+	int64_t x, k;
+	vector<uint32_t> node_children;
+	while (p < end) {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+		if (p == end) break;
+		char type = *p++;
+		if (type == 'n' || type == 'c') {
+			// header counts are not reliable in d4 output, so only the variable count is used
+			if (type == 'n') {
+				p += 2;
+				if (!read_int(p, end, x) || !read_int(p, end, x) || !read_int(p, end, x)) return false;
+				vars = max<int64_t>(vars, x);
+			}
+		} else if (type == 'L') {
+			if (!read_int(p, end, x) || x == 0) return false;
+			node_children.clear();
+			add_node(LITERAL, x, node_children);
+		} else if (type == 'A' || type == 'O') {
+			int64_t decision = 0;
+			if (type == 'O' && !read_int(p, end, decision)) return false;
+			if (!read_int(p, end, k)) return false;
+			node_children.clear();
+			for (int64_t j = 0; j < k; j++) {
+				if (!read_int(p, end, x) || x < 0 || x >= (int64_t)node_storage.size()) return false;
+				node_children.push_back(x);
+			}
+			add_node(type == 'A' ? AND : OR, decision, node_children);
+		} else {
+			return false;
+		}
+		while (p < end && *p != '\n') p++;
+	}
+	finish();
+	return true;
+}
+
+bool DDNNF::map(const string & path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(Header)) {
+		close(fd);
+		return false;
+	}
+	mapping_size = st.st_size;
+	mapping = mmap(NULL, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		mapping = NULL;
+		return false;
+	}
+	const Header * header = (const Header *)mapping;
+	const uint8_t * base = (const uint8_t *)mapping;
+	if (header->version != DDNNF_FORMAT_VERSION || header->nodes < 2 || header->nodes > UINT32_MAX
+		|| header->vars > INT32_MAX || header->leaves > UINT32_MAX || header->child_bytes > mapping_size)
+		return false;
+	uint64_t node_bytes = header->nodes * sizeof(Node);
+	uint64_t index_bytes = (2*(uint64_t)header->vars+3) * sizeof(uint64_t);
+	uint64_t leaf_bytes = (header->leaves * sizeof(uint32_t) + 7) / 8 * 8;
+	if (sizeof(Header) + node_bytes + index_bytes + leaf_bytes + header->child_bytes != mapping_size)
+		return false;
+	vars = header->vars;
+	n_nodes = header->nodes;
+	nodes = (const Node *)(base + sizeof(Header));
+	literal_begin = (const uint64_t *)(base + sizeof(Header) + node_bytes);
+	literal_leaves = (const uint32_t *)(base + sizeof(Header) + node_bytes + index_bytes);
+	child_data = base + sizeof(Header) + node_bytes + index_bytes + leaf_bytes;
+	if (!validate(header->child_bytes, header->leaves)) return false;
+	sat.assign(size(), 0);
+	visited.clear();
+	evaluated = false;
+	enumerating = false;
+	return true;
+}
+
+bool DDNNF::validate(uint64_t child_bytes, uint64_t n_leaf_entries) const
+{
+	// a mapped file is checked once in full, so that a corrupt or truncated one is rejected
+	// here instead of sending a query out of bounds: the children of each node are complete
+	// varints in its own byte range and precede it, literals are in range, and the index of
+	// the leaves lists every leaf exactly once under its literal
+	if (nodes[0].begin != 0 || nodes[n_nodes-1].begin != child_bytes) return false;
+	uint64_t n_literal_nodes = 0;
+	for (uint32_t i = 0; i < size(); i++) {
+		const Node & node = nodes[i];
+		if (node.begin > nodes[i+1].begin || (node.type != LITERAL && node.type != AND && node.type != OR))
+			return false;
+		if (node.literal == INT32_MIN || (uint32_t)abs(node.literal) > vars) return false;
+		if (node.type == LITERAL) {
+			if (node.literal == 0 || node.begin != nodes[i+1].begin) return false;
+			n_literal_nodes++;
+			continue;
+		}
+		const uint8_t * p = child_data + node.begin;
+		const uint8_t * end = child_data + nodes[i+1].begin;
+		uint64_t last = i;
+		while (p < end) {
+			uint64_t gap = 0;
+			for (uint32_t shift = 0; ; shift += 7) {
+				if (p == end || shift > 28) return false;
+				gap |= (uint64_t)(*p & 127) << shift;
+				if (!(*p++ & 128)) break;
+			}
+			if (gap == 0 || gap > last) return false;
+			last -= gap;
+		}
+	}
+	if (n_literal_nodes != n_leaf_entries) return false;
+	for (uint32_t l = 0; l < 2*vars+3; l++) {
+		if (literal_begin[l] > (l < 2 ? 0 : n_leaf_entries) || (l > 0 && literal_begin[l] < literal_begin[l-1]))
+			return false;
+	}
+	if (literal_begin[2*vars+2] != n_leaf_entries) return false;
+	for (uint32_t l = 2; l < 2*vars+2; l++) {
+		for (uint64_t j = literal_begin[l]; j < literal_begin[l+1]; j++) {
+			uint32_t leaf = literal_leaves[j];
+			if (leaf >= size() || nodes[leaf].type != LITERAL || literal_index(nodes[leaf].literal) != l
+				|| (j > literal_begin[l] && leaf <= literal_leaves[j-1]))
+				return false;
+		}
+	}
+	return true;
+}
+
+bool DDNNF::save(const string & path) const
+{
+	FILE * file = fopen(path.c_str(), "wb");
+	if (!file) return false;
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DDNNF_MAGIC, 8);
+	header.version = DDNNF_FORMAT_VERSION;
+	header.vars = vars;
+	header.nodes = n_nodes;
+	header.leaves = literal_begin[2*vars+2];
+	header.child_bytes = nodes[n_nodes-1].begin;
+	// records are copied with their padding zeroed, so that equal circuits give equal files
+	vector<uint8_t> node_bytes(n_nodes * sizeof(Node), 0);
+	for (uint32_t i = 0; i < n_nodes; i++) {
+		Node * record = (Node *)(node_bytes.data() + i*sizeof(Node));
+		record->begin = nodes[i].begin;
+		record->literal = nodes[i].literal;
+		record->type = nodes[i].type;
+	}
+	uint64_t padding = 0;
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+		&& fwrite(node_bytes.data(), 1, node_bytes.size(), file) == node_bytes.size()
+		&& fwrite(literal_begin, sizeof(uint64_t), 2*vars+3, file) == 2*vars+3
+		&& fwrite(literal_leaves, sizeof(uint32_t), header.leaves, file) == header.leaves
+		&& fwrite(&padding, 1, (8 - header.leaves*sizeof(uint32_t) % 8) % 8, file) == (8 - header.leaves*sizeof(uint32_t) % 8) % 8
+		&& fwrite(child_data, 1, header.child_bytes, file) == header.child_bytes;
+	return fclose(file) == 0 && ok;
+}
+
+bool DDNNF::condition(const vector<int32_t> & lits)
+{
+	bool consistent = true;
+	for (uint32_t i = 0; i < lits.size(); i++) {
+		uint32_t var = abs(lits[i]);
+		if (var >= assigned.size()) assigned.resize(var+1, 0);
+		int8_t sign = (lits[i] > 0 ? 1 : -1);
+		if (assigned[var] == -sign) consistent = false;
+		assigned[var] = sign;
+	}
+	return consistent;
+}
+
+void DDNNF::uncondition(const vector<int32_t> & lits)
+{
+	for (uint32_t i = 0; i < lits.size(); i++)
+		assigned[abs(lits[i])] = 0;
+}
+
+int8_t DDNNF::value(int32_t lit) const
+{
+	uint32_t var = abs(lit);
+	if (var >= assigned.size()) return 0;
+	return (lit > 0 ? assigned[var] : -assigned[var]);
+}
+
+void DDNNF::clear_sat()
+{
+	if (evaluated || visited.size() > size()/8) {
+		sat.assign(size(), 0);
+	} else {
+		for (uint32_t i = 0; i < visited.size(); i++) sat[visited[i]] = 0;
+	}
+	visited.clear();
+	evaluated = false;
+}
+
+void DDNNF::evaluate()
+{
+	for (uint32_t i = 0; i < size(); i++) {
+		const Node & node = nodes[i];
+		if (node.type == LITERAL) {
+			sat[i] = (value(node.literal) >= 0 ? 1 : 2);
+			continue;
+		}
+		uint8_t stop = (node.type == AND ? 2 : 1);
+		sat[i] = (node.type == AND ? 1 : 2);
+		Children ch = children(i);
+		for (uint32_t child; ch.next(child); ) {
+			if (sat[child] == stop) {
+				sat[i] = stop;
+				break;
+			}
+		}
+	}
+	visited.clear();
+	evaluated = true;
+}
+
+bool DDNNF::satisfiable(const vector<int32_t> & lits)
+{
+	clear_sat();
+	if (!condition(lits)) {
+		uncondition(lits);
+		return false;
+	}
+	// depth-first from the root, stopping at the first satisfiable child of an OR node and
+	// the first unsatisfiable child of an AND node, so only the nodes needed are visited
+	struct Frame {
+		uint32_t node;
+		uint32_t pending;
+		Children children;
+	};
+	vector<Frame> stack;
+	stack.push_back({ root(), UINT32_MAX, children(root()) });
+	visited.push_back(root());
+	while (!stack.empty()) {
+		Frame & frame = stack.back();
+		const Node & node = nodes[frame.node];
+		uint8_t stop = (node.type == AND ? 2 : 1);
+		uint8_t result = 0;
+		if (node.type == LITERAL) {
+			result = (value(node.literal) >= 0 ? 1 : 2);
+		} else if (frame.pending != UINT32_MAX && sat[frame.pending] == stop) {
+			result = stop;
+		}
+		uint32_t child;
+		while (!result) {
+			if (!frame.children.next(child)) {
+				result = (node.type == AND ? 1 : 2);
+			} else if (!sat[child]) {
+				frame.pending = child;
+				break;
+			} else if (sat[child] == stop) {
+				result = stop;
+			}
+		}
+		if (result) {
+			sat[frame.node] = result;
+			stack.pop_back();
+		} else {
+			visited.push_back(child);
+			stack.push_back({ child, UINT32_MAX, children(child) });
+		}
+	}
+	uncondition(lits);
+	return sat[root()] == 1;
+}
+
+bool DDNNF::model(const vector<int32_t> & lits, vector<int32_t> & out_model)
+{
+	if (!satisfiable(lits)) return false;
+	// follow a satisfiable child of every OR node; the literals reached form an implicant
+	vector<int8_t> values(vars+1, 0);
+	for (uint32_t i = 0; i < lits.size(); i++) {
+		if ((uint32_t)abs(lits[i]) <= vars) values[abs(lits[i])] = (lits[i] > 0 ? 1 : -1);
+	}
+	vector<uint32_t> stack(1, root());
+	while (!stack.empty()) {
+		uint32_t i = stack.back();
+		stack.pop_back();
+		const Node & node = nodes[i];
+		if (node.type == LITERAL) {
+			values[abs(node.literal)] = (node.literal > 0 ? 1 : -1);
+			continue;
+		}
+		// children of an AND node share no variables, so only constant nodes are reached twice
+		Children ch = children(i);
+		for (uint32_t child; ch.next(child); ) {
+			if (node.type == OR && sat[child] != 1) continue;
+			stack.push_back(child);
+			if (node.type == OR) break;
+		}
+	}
+	out_model.clear();
+	for (uint32_t v = 1; v <= vars; v++)
+		out_model.push_back(values[v] > 0 ? (int32_t)v : -(int32_t)v);
+	return true;
+}
+void DDNNF::count_nodes(vector<Natural> & counts)
+{
+	// counts are over the free variables, which keeps them exact without smoothing the circuit:
+	// a node stands for the assignments to all free variables that satisfy it
+	uint32_t free = vars;
+	for (uint32_t v = 1; v <= vars; v++) {
+		if (value(v)) free--;
+	}
+	counts.assign(size(), Natural());
+	for (uint32_t i = 0; i < size(); i++) {
+		const Node & node = nodes[i];
+		Children ch = children(i);
+		uint32_t child;
+		if (node.type == LITERAL) {
+			int8_t val = value(node.literal);
+			if (val > 0) counts[i] = power_of_two(free);
+			else if (val == 0) counts[i] = power_of_two(free-1);
+		} else if (node.type == AND) {
+			counts[i] = power_of_two(free);
+			while (!counts[i].empty() && ch.next(child))
+				counts[i] = multiply_shift(counts[i], counts[child], free);
+		} else {
+			while (ch.next(child))
+				add(counts[i], counts[child]);
+		}
+	}
+}
+
+string DDNNF::count(const vector<int32_t> & lits)
+{
+	if (!condition(lits)) {
+		uncondition(lits);
+		return "0";
+	}
+	vector<Natural> counts;
+	count_nodes(counts);
+	uncondition(lits);
+	return to_string(counts[root()]);
+}
+
+// values of the nodes and derivatives of the root by them, over a commutative semiring given by
+// its zero, one, addition and multiplication, with the values of the literals indexed by
+// literal_index; in both passes the children of a node are read once, so they are linear
+template<class Ring>
+static void node_values(const DDNNF & ddnnf, const vector<typename Ring::Value> & literal_value, vector<typename Ring::Value> & value)
+{
+	value.assign(ddnnf.size(), Ring::one());
+	for (uint32_t i = 0; i < ddnnf.size(); i++) {
+		const DDNNF::Node & node = ddnnf.node(i);
+		DDNNF::Children ch = ddnnf.children(i);
+		uint32_t child;
+		if (node.type == DDNNF::LITERAL) {
+			value[i] = literal_value[DDNNF::literal_index(node.literal)];
+		} else if (node.type == DDNNF::AND) {
+			while (ch.next(child)) value[i] = Ring::multiply(value[i], value[child]);
+		} else {
+			value[i] = Ring::zero();
+			while (ch.next(child)) value[i] = Ring::add(value[i], value[child]);
+		}
+	}
+}
+
+template<class Ring>
+static void node_derivatives(const DDNNF & ddnnf, const vector<typename Ring::Value> & value, vector<typename Ring::Value> & derivative)
+{
+	// top-down: the child of an AND node is multiplied by the product of its siblings, kept as
+	// prefix and suffix products
+	typedef typename Ring::Value Value;
+	vector<Value> suffix;
+	vector<uint32_t> node_children;
+	derivative.assign(ddnnf.size(), Ring::zero());
+	derivative[ddnnf.root()] = Ring::one();
+	for (int32_t i = ddnnf.root(); i >= 0; i--) {
+		if (ddnnf.node(i).type == DDNNF::LITERAL || derivative[i] == Ring::zero()) continue;
+		DDNNF::Children ch = ddnnf.children(i);
+		uint32_t child;
+		if (ddnnf.node(i).type == DDNNF::OR) {
+			while (ch.next(child)) derivative[child] = Ring::add(derivative[child], derivative[i]);
+			continue;
+		}
+		node_children.clear();
+		while (ch.next(child)) node_children.push_back(child);
+		suffix.assign(node_children.size()+1, Ring::one());
+		for (int32_t j = node_children.size()-1; j >= 0; j--) suffix[j] = Ring::multiply(suffix[j+1], value[node_children[j]]);
+		Value prefix = derivative[i];
+		for (uint32_t j = 0; j < node_children.size(); j++) {
+			child = node_children[j];
+			derivative[child] = Ring::add(derivative[child], Ring::multiply(prefix, suffix[j+1]));
+			prefix = Ring::multiply(prefix, value[child]);
+		}
+	}
+}
+
+// logarithms are summed in extended precision, as their rounding errors grow with their magnitude
+typedef long double Log;
+
+static Log log_add(Log a, Log b)
+{
+	if (a == -INFINITY) return b;
+	if (b == -INFINITY) return a;
+	return max(a, b) + log1p(exp(-fabs(a-b)));
+}
+
+struct LogSpace {
+	typedef Log Value;
+	static Log zero() { return -INFINITY; }
+	static Log one() { return 0; }
+	static Log add(Log a, Log b) { return log_add(a, b); }
+	static Log multiply(Log a, Log b) { return a + b; }
+};
+
+void DDNNF::satisfiable_literals(const vector<int32_t> & lits, vector<uint8_t> & positive, vector<uint8_t> & negative)
+{
+	positive.assign(vars+1, 0);
+	negative.assign(vars+1, 0);
+	if (!condition(lits)) {
+		uncondition(lits);
+		return;
+	}
+	evaluate();
+	if (sat[root()] != 1) {
+		uncondition(lits);
+		return;
+	}
+	// top-down: a node is reached if it lies on a satisfiable proof tree of the root
+	reach.assign(size(), 0);
+	reach[root()] = 1;
+	for (int32_t i = root(); i >= 0; i--) {
+		if (!reach[i] || nodes[i].type == LITERAL) continue;
+		Children ch = children(i);
+		for (uint32_t child; ch.next(child); ) {
+			if (sat[child] == 1) reach[child] = 1;
+		}
+	}
+	vector<uint8_t> mentioned(vars+1, 0);
+	for (uint32_t v = 1; v <= vars; v++) {
+		for (int32_t lit : { (int32_t)v, -(int32_t)v }) {
+			for (uint32_t j = 0; j < n_leaves(lit); j++) {
+				mentioned[v] = 1;
+				if (reach[leaves(lit)[j]]) (lit > 0 ? positive : negative)[v] = 1;
+			}
+		}
+	}
+	vector<uint32_t> left;
+	for (uint32_t v = 1; v <= vars; v++) {
+		if (value(v)) {
+			positive[v] = (value(v) > 0);
+			negative[v] = (value(v) < 0);
+		} else if (!mentioned[v]) {
+			positive[v] = negative[v] = 1;
+		} else if (!positive[v] || !negative[v]) {
+			left.push_back(v);
+		}
+	}
+	if (left.empty()) {
+		uncondition(lits);
+		return;
+	}
+	// a variable missing from some satisfiable proof tree is free in it, so both literals are
+	// satisfiable; the variables left are decided 64 at a time, a bit for each, of whether a
+	// satisfiable proof tree avoids them. Only the ancestors of the leaves of a block depend on
+	// it, so each block is passed up from its leaves along the edges to their parents, and an
+	// OR node with a satisfiable child outside the ancestors avoids the whole block
+	vector<uint32_t> parent_begin(size()+1, 0), parents, sat_children(size(), 0);
+	for (uint32_t i = 0; i < size(); i++) {
+		Children ch = children(i);
+		for (uint32_t child; ch.next(child); ) {
+			parent_begin[child+1]++;
+			if (sat[child] == 1) sat_children[i]++;
+		}
+	}
+	for (uint32_t i = 0; i < size(); i++) parent_begin[i+1] += parent_begin[i];
+	parents.resize(parent_begin[size()]);
+	vector<uint32_t> filled(parent_begin.begin(), parent_begin.end()-1);
+	for (uint32_t i = 0; i < size(); i++) {
+		Children ch = children(i);
+		for (uint32_t child; ch.next(child); ) parents[filled[child]++] = i;
+	}
+	vector<uint8_t> bit(vars+1, 64);
+	vector<uint32_t> mark(size(), 0), marked_sat(size()), block_nodes;
+	vector<uint64_t> avoid(size());
+	for (uint32_t begin = 0; begin < left.size(); begin += 64) {
+		uint32_t end = min<uint32_t>(begin + 64, left.size()), stamp = begin/64 + 1;
+		block_nodes.clear();
+		for (uint32_t b = begin; b < end; b++) {
+			int32_t v = left[b];
+			bit[v] = b - begin;
+			for (int32_t lit : { v, -v }) {
+				for (uint32_t j = 0; j < n_leaves(lit); j++) {
+					uint32_t leaf = leaves(lit)[j];
+					if (mark[leaf] == stamp) continue;
+					mark[leaf] = stamp;
+					block_nodes.push_back(leaf);
+				}
+			}
+		}
+		for (uint32_t k = 0; k < block_nodes.size(); k++) {
+			uint32_t i = block_nodes[k];
+			for (uint32_t j = parent_begin[i]; j < parent_begin[i+1]; j++) {
+				uint32_t parent = parents[j];
+				if (mark[parent] == stamp) continue;
+				mark[parent] = stamp;
+				avoid[parent] = (nodes[parent].type == AND ? ~0ULL : 0);
+				marked_sat[parent] = 0;
+				block_nodes.push_back(parent);
+			}
+		}
+		// children come before their parents
+		sort(block_nodes.begin(), block_nodes.end());
+		for (uint32_t i : block_nodes) {
+			const Node & node = nodes[i];
+			if (sat[i] != 1) {
+				avoid[i] = 0;
+			} else if (node.type == LITERAL) {
+				uint8_t b = bit[abs(node.literal)];
+				avoid[i] = (b < 64 ? ~(1ULL << b) : ~0ULL);
+			} else if (node.type == OR && marked_sat[i] < sat_children[i]) {
+				avoid[i] = ~0ULL;
+			}
+			for (uint32_t j = parent_begin[i]; j < parent_begin[i+1]; j++) {
+				uint32_t parent = parents[j];
+				if (nodes[parent].type == AND) {
+					avoid[parent] &= avoid[i];
+				} else {
+					avoid[parent] |= avoid[i];
+					if (sat[i] == 1) marked_sat[parent]++;
+				}
+			}
+		}
+		uint64_t avoided = (mark[root()] == stamp ? avoid[root()] : ~0ULL);
+		for (uint32_t b = begin; b < end; b++) {
+			if ((avoided >> (b - begin)) & 1) positive[left[b]] = negative[left[b]] = 1;
+			bit[left[b]] = 64;
+		}
+	}
+	uncondition(lits);
+}
+
+Log DDNNF::log_weights(const vector<double> & weights, vector<Log> & probability, vector<Log> & log_value)
+{
+	// the weights of each variable are normalized to the probability of it being true, so that
+	// a node stands for the probability of a random assignment to all variables satisfying it,
+	// which keeps the values exact without smoothing the circuit; conditioning zeroes a weight
+	Log log_total = 0;
+	probability.assign(vars+1, 0);
+	vector<Log> literal_value(2*vars+2, 0);
+	for (int32_t v = 1; v <= (int32_t)vars; v++) {
+		Log pos = (literal_index(v) < weights.size() ? weights[literal_index(v)] : 1);
+		Log neg = (literal_index(-v) < weights.size() ? weights[literal_index(-v)] : 1);
+		if (value(v) > 0) neg = 0;
+		if (value(v) < 0) pos = 0;
+		if (!(pos+neg > 0)) return -INFINITY;
+		probability[v] = pos/(pos+neg);
+		log_total += log(pos+neg);
+		literal_value[literal_index(v)] = log(probability[v]);
+		literal_value[literal_index(-v)] = log1p(-probability[v]);
+	}
+	node_values<LogSpace>(*this, literal_value, log_value);
+	return log_total + log_value[root()];
+}
+
+double DDNNF::log_weighted_count(const vector<int32_t> & lits, const vector<double> & weights)
+{
+	if (!condition(lits)) {
+		uncondition(lits);
+		return -INFINITY;
+	}
+	vector<Log> probability, log_value;
+	Log log_count = log_weights(weights, probability, log_value);
+	uncondition(lits);
+	return log_count;
+}
+
+double DDNNF::probabilities(const vector<int32_t> & lits, const vector<double> & weights, vector<double> & out_probability)
+{
+	out_probability.assign(vars+1, 0);
+	if (!condition(lits)) {
+		uncondition(lits);
+		return -INFINITY;
+	}
+	vector<Log> probability, log_value, log_derivative;
+	Log log_count = log_weights(weights, probability, log_value);
+	if (log_count == -INFINITY) {
+		uncondition(lits);
+		return log_count;
+	}
+	node_derivatives<LogSpace>(*this, log_value, log_derivative);
+	// with p the probability of v and R the root, the probability of v and R is p*R plus
+	// p*(1-p) times the derivatives of R by the leaves of v minus those by the leaves of -v,
+	// as a subcircuit without v contributes p times its value either way
+	Log log_root = log_value[root()];
+	for (int32_t v = 1; v <= (int32_t)vars; v++) {
+		Log p = probability[v], positive = -INFINITY, negative = -INFINITY;
+		for (uint32_t j = 0; j < n_leaves(v); j++) positive = log_add(positive, log_derivative[leaves(v)[j]]);
+		for (uint32_t j = 0; j < n_leaves(-v); j++) negative = log_add(negative, log_derivative[leaves(-v)[j]]);
+		Log share = p + p*(1-p)*(exp(positive-log_root) - exp(negative-log_root));
+		out_probability[v] = min<Log>(1, max<Log>(0, share));
+	}
+	uncondition(lits);
+	return log_count;
+}
+
+bool DDNNF::sample(const vector<int32_t> & lits, uint32_t n_samples, mt19937 & rng, vector<vector<int32_t>> & out_models)
+{
+	out_models.clear();
+	if (!condition(lits)) {
+		uncondition(lits);
+		return false;
+	}
+	vector<Natural> counts;
+	count_nodes(counts);
+	if (counts[root()].empty()) {
+		uncondition(lits);
+		return false;
+	}
+	// top-down, every OR node picks a child with probability proportional to its count, and
+	// the variables left unset are free in the proof tree reached, so they are set uniformly
+	vector<int8_t> values(vars+1, 0);
+	vector<uint32_t> stack;
+	for (uint32_t k = 0; k < n_samples; k++) {
+		for (uint32_t v = 1; v <= vars; v++) values[v] = value(v);
+		stack.assign(1, root());
+		while (!stack.empty()) {
+			uint32_t i = stack.back();
+			stack.pop_back();
+			const Node & node = nodes[i];
+			if (node.type == LITERAL) {
+				values[abs(node.literal)] = (node.literal > 0 ? 1 : -1);
+				continue;
+			}
+			Children ch = children(i);
+			uint32_t child;
+			if (node.type == AND) {
+				while (ch.next(child)) stack.push_back(child);
+				continue;
+			}
+			Natural r = random_below(counts[i], rng);
+			while (ch.next(child)) {
+				if (smaller(r, counts[child])) break;
+				subtract(r, counts[child]);
+			}
+			stack.push_back(child);
+		}
+		out_models.push_back(vector<int32_t>());
+		for (uint32_t v = 1; v <= vars; v++) {
+			if (!values[v]) values[v] = (rng() & 1 ? 1 : -1);
+			out_models.back().push_back(values[v] > 0 ? (int32_t)v : -(int32_t)v);
+		}
+	}
+	uncondition(lits);
+	return true;
+}
+
+bool DDNNF::start_enumeration(const vector<int32_t> & lits)
+{
+	clear_sat();
+	enumerating = false;
+	if (!condition(lits)) {
+		uncondition(lits);
+		return false;
+	}
+	evaluate();
+	live = sat;
+	fixed.assign(vars+1, 0);
+	for (uint32_t v = 1; v <= vars; v++) fixed[v] = value(v);
+	uncondition(lits);
+	if (live[root()] != 1) return false;
+	choice.assign(size(), 0);
+	kept.assign(size(), 0);
+	decisions.clear();
+	free_vars.clear();
+	stamp = 0;
+	enumerating = first_tree = true;
+	return true;
+}
+
+bool DDNNF::next_child(uint32_t i, uint32_t & position, uint32_t & out_child)
+{
+	// the first satisfiable child of OR node i at the given position or after it
+	Children ch = children(i);
+	uint32_t child;
+	for (uint32_t j = 0; ch.next(child); j++) {
+		if (j >= position && live[child] == 1) {
+			position = j;
+			out_child = child;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool DDNNF::next_model(vector<int32_t> & out_model)
+{
+	if (!enumerating) return false;
+	// the free variables of the current proof tree are counted through in binary first
+	uint32_t j = 0;
+	while (j < free_vars.size() && enum_values[free_vars[j]] > 0) enum_values[free_vars[j++]] = -1;
+	if (j < free_vars.size()) {
+		enum_values[free_vars[j]] = 1;
+	} else {
+		// then the choices of the OR nodes, in the order the last proof tree was traversed, are
+		// advanced as an odometer: the last one that has a satisfiable child left moves to it,
+		// those before it are kept, and those after it restart from their first child
+		int32_t d = (first_tree ? -1 : (int32_t)decisions.size()-1);
+		for (; d >= 0; d--) {
+			uint32_t position = choice[decisions[d]]+1, child;
+			if (next_child(decisions[d], position, child)) {
+				choice[decisions[d]] = position;
+				break;
+			}
+		}
+		if (d < 0 && !first_tree) {
+			enumerating = false;
+			return false;
+		}
+		first_tree = false;
+		if (stamp >= UINT32_MAX-2) {
+			kept.assign(size(), 0);
+			stamp = 0;
+		}
+		stamp += 2;
+		for (int32_t k = 0; k <= d; k++) kept[decisions[k]] = stamp;
+		decisions.clear();
+		enum_values = fixed;
+		enum_stack.assign(1, root());
+		while (!enum_stack.empty()) {
+			uint32_t i = enum_stack.back();
+			enum_stack.pop_back();
+			const Node & node = nodes[i];
+			if (node.type == LITERAL) {
+				enum_values[abs(node.literal)] = (node.literal > 0 ? 1 : -1);
+			} else if (node.type == AND) {
+				Children ch = children(i);
+				for (uint32_t child; ch.next(child); ) enum_stack.push_back(child);
+			} else if (kept[i] != stamp+1) {
+				// an OR node reached twice in one proof tree has no variables, and counts once
+				uint32_t position = 0, child;
+				if (kept[i] == stamp) position = choice[i];
+				next_child(i, position, child);
+				choice[i] = position;
+				kept[i] = stamp+1;
+				decisions.push_back(i);
+				enum_stack.push_back(child);
+			}
+		}
+		free_vars.clear();
+		for (uint32_t v = 1; v <= vars; v++) {
+			if (!enum_values[v]) {
+				free_vars.push_back(v);
+				enum_values[v] = -1;
+			}
+		}
+	}
+	out_model.clear();
+	for (uint32_t v = 1; v <= vars; v++)
+		out_model.push_back(enum_values[v] > 0 ? (int32_t)v : -(int32_t)v);
+	return true;
+}
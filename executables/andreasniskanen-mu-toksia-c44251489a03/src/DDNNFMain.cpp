@@ -0,0 +1,348 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "DDNNF.h"
+#include "Compiler.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <getopt.h>
+#include <chrono>
+#include <iomanip>
+#include <unordered_map>
+#include <map>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static int usage_flag = 0;
+static int scc_flag = 0;
+
+void print_model(const vector<int32_t> & model)
+{
+	cout << "v";
+	for (uint32_t i = 0; i < model.size(); i++) cout << " " << model[i];
+	cout << " 0\n";
+}
+
+void print_usage(string name)
+{
+	cout << "Usage: " << name << " [-cmd <file>] [-threads <n>] [-scc] [-seed <s>]\n\n";
+	cout << "  <file>      commands to run, one per line (default: standard input)\n";
+	cout << "  <n>         threads used by compile (default: number of cores)\n";
+	cout << "  -scc        compile decides the SCCs of the AF in topological order, and caches them by shape\n";
+	cout << "  <s>         seed of the random numbers used by sample (default: 0)\n";
+	cout << "Commands:\n";
+	cout << "  load <file>      reads a d-DNNF in the c2d/NNF format, or maps one in the binary format\n";
+	cout << "  compile <file> [AD|CO|ST] [<s> <t>]...\n";
+	cout << "                   compiles the extensions of an AF in the ICCMA'23 or tgf format (default: ST),\n";
+	cout << "                   with the attacks from <s> to <t> dynamic, given by the argument names in the file\n";
+	cout << "  add <s> <t>      adds the dynamic attack from <s> to <t> for all following queries\n";
+	cout << "  del <s> <t>      deletes the dynamic attack from <s> to <t> for all following queries\n";
+	cout << "  save <file>      writes the d-DNNF in the binary format\n";
+	cout << "  cond [lits]      sets the literals true for all following queries\n";
+	cout << "  sat [lits]       is the d-DNNF satisfiable with the literals set true\n";
+	cout << "  model [lits]     prints a model with the literals set true\n";
+	cout << "  count [lits]     prints the number of models with the literals set true\n";
+	cout << "  lits [lits]      prints every literal that can be set true together with the literals\n";
+	cout << "  enum [lits]      prints every model with the literals set true\n";
+	cout << "  sample <n> [lits]\n";
+	cout << "                   prints n models with the literals set true, drawn uniformly at random\n";
+	cout << "  weight <lit> <w> sets the weight of a literal for all following queries (default: 1)\n";
+	cout << "  wmc [lits]       prints the sum of the weights of the models with the literals set true\n";
+	cout << "  probs [lits]     prints the probability of each variable in a model with the literals set\n";
+	cout << "                   true, drawn by weight\n";
+}
+
+void print_log_count(double log_count)
+{
+	// beyond the range of a double, the mantissa and the exponent are printed separately
+	if (log_count == -INFINITY) {
+		cout << "0" << endl;
+	} else if (log_count < 700) {
+		cout << std::setprecision(12) << std::defaultfloat << exp(log_count) << endl;
+	} else {
+		double exponent = floor(log_count/log(10.0));
+		cout << std::setprecision(12) << std::defaultfloat << exp(log_count - exponent*log(10.0)) << "e+" << (int64_t)exponent << endl;
+	}
+}
+
+bool read_af(string path, DynamicAF & af, unordered_map<string,int32_t> & arg_str_to_int)
+{
+	ifstream input(path);
+	if (!input.good()) return false;
+	string line, source, target;
+	// arguments are numbered in order of appearance, so argument i is accepted in variable i
+	if (input.peek() == 'p' || input.peek() == '#') {
+		while (getline(input, line)) {
+			if (line.length() == 0 || line[0] == '#') continue;
+			std::istringstream iss(line);
+			if (line[0] == 'p') {
+				string p, format;
+				int32_t n_args = 0;
+				iss >> p >> format >> n_args;
+				for (int32_t i = 1; i <= n_args; i++) {
+					arg_str_to_int[to_string(i)] = i;
+					af.add_argument(i);
+				}
+			} else {
+				int32_t s, t;
+				if (iss >> s >> t) af.add_attack(s, t);
+			}
+		}
+		return true;
+	}
+	int32_t n_args = 0;
+	while (getline(input, line)) {
+		std::istringstream iss(line);
+		if (!(iss >> source)) continue;
+		if (source == "#") break;
+		arg_str_to_int[source] = ++n_args;
+		af.add_argument(arg_str_to_int[source]);
+	}
+	while (getline(input, line)) {
+		std::istringstream iss(line);
+		if (!(iss >> source >> target)) continue;
+		if (!arg_str_to_int.count(source) || !arg_str_to_int.count(target)) return false;
+		af.add_attack(arg_str_to_int[source], arg_str_to_int[target]);
+	}
+	return true;
+}
+
+int main(int argc, char ** argv)
+{
+	ios_base::sync_with_stdio(false);
+	cin.tie(NULL);
+
+	const struct option longopts[] =
+	{
+		{"help", no_argument, &usage_flag, 1},
+		{"scc", no_argument, &scc_flag, 1},
+		{"cmd", required_argument, 0, 'c'},
+		{"threads", required_argument, 0, 't'},
+		{"seed", required_argument, 0, 's'},
+		{0, 0, 0, 0}
+	};
+
+	int option_index = 0;
+	int opt = 0;
+	string commands;
+	uint32_t threads = max(thread::hardware_concurrency(), 1u);
+	uint32_t seed = 0;
+
+	while ((opt = getopt_long_only(argc, argv, "", longopts, &option_index)) != -1) {
+		switch (opt) {
+			case 0:
+				break;
+			case 'c':
+				commands = optarg;
+				break;
+			case 't':
+				threads = max(atoi(optarg), 1);
+				break;
+			case 's':
+				seed = strtoul(optarg, NULL, 10);
+				break;
+			default:
+				return 1;
+		}
+	}
+
+	if (usage_flag) {
+		print_usage(argv[0]);
+		return 0;
+	}
+
+	ifstream file;
+	if (!commands.empty()) {
+		file.open(commands);
+		if (!file.good()) {
+			cerr << argv[0] << ": Cannot open command file\n";
+			return 1;
+		}
+	}
+	istream & input = (commands.empty() ? cin : file);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	DDNNF ddnnf;
+	string line, command;
+	vector<int32_t> conditioned, lits, model;
+	// the position of each dynamic attack, and the literals of their selectors setting the current attacks
+	map<pair<string,string>,int32_t> selectors;
+	vector<int32_t> structure;
+	vector<uint8_t> positive, negative;
+	vector<double> weights, probability;
+	vector<vector<int32_t>> samples;
+	mt19937 rng(seed);
+	while (getline(input, line)) {
+		std::istringstream iss(line);
+		if (!(iss >> command) || command == "c") continue;
+		if (command == "load") {
+			string path;
+			iss >> path;
+			if (!ddnnf.load(path)) {
+				cerr << argv[0] << ": Cannot parse d-DNNF " << path << "\n";
+				return 1;
+			}
+			cout << "c loaded " << ddnnf.size() << " nodes over " << ddnnf.vars << " variables" << endl;
+			conditioned.clear();
+			selectors.clear();
+			structure.clear();
+			weights.clear();
+			continue;
+		}
+		if (command == "compile") {
+			string path, semantics = "ST", source, target;
+			iss >> path >> semantics;
+			DynamicAF af;
+			af.static_mode = true;
+			af.sem = (semantics == "AD" ? AD : semantics == "CO" ? CO : semantics == "ST" ? ST : UNKNOWN_SEM);
+			unordered_map<string,int32_t> arg_str_to_int;
+			if (!read_af(path, af, arg_str_to_int)) {
+				cerr << argv[0] << ": Cannot parse AF " << path << "\n";
+				return 1;
+			}
+			af.initialize_attackers();
+			af.set_var_count();
+			selectors.clear();
+			structure.clear();
+			vector<pair<int32_t,int32_t>> dynamic_attacks;
+			while (iss >> source >> target) {
+				if (!arg_str_to_int.count(source) || !arg_str_to_int.count(target)) {
+					cerr << argv[0] << ": Unknown attack " << source << " " << target << "\n";
+					return 1;
+				}
+				if (selectors.count(make_pair(source, target))) continue;
+				pair<int32_t,int32_t> attack(af.arg_to_int[arg_str_to_int[source]], af.arg_to_int[arg_str_to_int[target]]);
+				int32_t selector = af.args+dynamic_attacks.size()+1;
+				selectors[make_pair(source, target)] = structure.size();
+				structure.push_back(af.attacks.count(attack) ? selector : -selector);
+				dynamic_attacks.push_back(attack);
+			}
+			if (!Compiler::compile(af, ddnnf, threads, scc_flag, dynamic_attacks)) {
+				cerr << argv[0] << ": Semantics " << semantics << " not supported\n";
+				return 1;
+			}
+			cout << "c loaded " << ddnnf.size() << " nodes over " << ddnnf.vars << " variables" << endl;
+			conditioned.clear();
+			weights.clear();
+			continue;
+		}
+		if (command == "weight") {
+			int32_t lit;
+			double weight;
+			if (!(iss >> lit >> weight) || lit == 0 || !(weight >= 0) || std::isinf(weight)) {
+				cerr << argv[0] << ": Invalid weight\n";
+				return 1;
+			}
+			if (DDNNF::literal_index(lit) >= weights.size()) weights.resize(DDNNF::literal_index(lit)+2, 1);
+			weights[DDNNF::literal_index(lit)] = weight;
+			continue;
+		}
+		if (command == "add" || command == "del") {
+			string source, target;
+			iss >> source >> target;
+			if (!selectors.count(make_pair(source, target))) {
+				cerr << argv[0] << ": Attack " << source << " " << target << " was not compiled as dynamic\n";
+				return 1;
+			}
+			int32_t & selector = structure[selectors[make_pair(source, target)]];
+			selector = (command == "add" ? abs(selector) : -abs(selector));
+			continue;
+		}
+		if (command == "save") {
+			string path;
+			iss >> path;
+			if (!ddnnf.save(path)) {
+				cerr << argv[0] << ": Cannot write d-DNNF " << path << "\n";
+				return 1;
+			}
+			continue;
+		}
+		uint32_t n_samples = 1;
+		if (command == "sample" && !(iss >> n_samples)) {
+			cerr << argv[0] << ": Invalid number of samples\n";
+			return 1;
+		}
+		lits = conditioned;
+		int32_t lit;
+		while (iss >> lit && lit != 0) lits.push_back(lit);
+		if (command == "cond") {
+			conditioned = lits;
+			continue;
+		}
+		lits.insert(lits.end(), structure.begin(), structure.end());
+		if (command == "sat") {
+			cout << (ddnnf.satisfiable(lits) ? "SAT" : "UNSAT") << endl;
+		} else if (command == "model") {
+			if (ddnnf.model(lits, model)) {
+				print_model(model);
+				cout << flush;
+			} else {
+				cout << "UNSAT" << endl;
+			}
+		} else if (command == "enum") {
+			if (!ddnnf.start_enumeration(lits)) cout << "UNSAT\n";
+			while (ddnnf.next_model(model)) print_model(model);
+			cout << flush;
+		} else if (command == "sample") {
+			if (!ddnnf.sample(lits, n_samples, rng, samples)) cout << "UNSAT\n";
+			for (uint32_t i = 0; i < samples.size(); i++) print_model(samples[i]);
+			cout << flush;
+		} else if (command == "lits") {
+			ddnnf.satisfiable_literals(lits, positive, negative);
+			cout << "l";
+			for (uint32_t v = 1; v <= ddnnf.vars; v++) {
+				if (positive[v]) cout << " " << v;
+				if (negative[v]) cout << " -" << v;
+			}
+			cout << " 0" << endl;
+		} else if (command == "count" || command == "mc") {
+			cout << ddnnf.count(lits) << endl;
+		} else if (command == "wmc") {
+			print_log_count(ddnnf.log_weighted_count(lits, weights));
+		} else if (command == "probs") {
+			if (ddnnf.probabilities(lits, weights, probability) == -INFINITY) {
+				cout << "UNSAT" << endl;
+			} else {
+				cout << "p";
+				for (uint32_t v = 1; v <= ddnnf.vars; v++) cout << " " << std::setprecision(12) << std::defaultfloat << probability[v];
+				cout << endl;
+			}
+		} else {
+			cerr << argv[0] << ": Unknown command " << command << "\n";
+			return 1;
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	cout << "c time " << std::setprecision(16) << std::fixed << std::chrono::duration<double>(end - start).count() << endl;
+	return 0;
+}
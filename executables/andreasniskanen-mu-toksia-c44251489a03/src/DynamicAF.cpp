@@ -30,13 +30,15 @@
 
 using namespace std;
 
-DynamicAF::DynamicAF() : args(0), args_remaining(0), count(0) {
+DynamicAF::DynamicAF() : args(0), args_remaining(0), count(0), group_base(0), version(0) {
 #if defined(DYNAMIC_ASSUMPS)
 	static_mode = false;
 #else
 	static_mode = true;
 #endif
 	vars_initialized = false;
+	dense = false;
+	lazy = false;
 }
 
 bool DynamicAF::add_argument(int32_t arg)
@@ -56,6 +58,7 @@ bool DynamicAF::add_argument(int32_t arg)
 	}
 	if (args > MAX_DYNAMIC_ARGS)
 		static_mode = true;
+	version++;
 	return true;
 }
 
@@ -74,6 +77,7 @@ bool DynamicAF::del_argument(int32_t arg)
 		if (attacks.count(make_pair(i, arg_index)))
 			attacks.erase(make_pair(i, arg_index));
 	}
+	version++;
 	return true;
 }
 
@@ -92,6 +96,7 @@ bool DynamicAF::add_attack(int32_t source, int32_t target)
 		return false;
 	}
 	attacks.insert(make_pair(source_index, target_index));
+	version++;
 	return true;
 }
 
@@ -110,6 +115,7 @@ bool DynamicAF::del_attack(int32_t source, int32_t target)
 		return false;
 	}
 	attacks.erase(make_pair(source_index, target_index));
+	version++;
 	return true;
 }
 
@@ -123,7 +129,6 @@ void DynamicAF::add_dummy_args(int32_t n_args) {
 
 void DynamicAF::initialize_attackers()
 {
-	if (!static_mode) return;
 	attackers.clear();
 	self_attack.clear();
 	symmetric_attacks.clear();
@@ -140,6 +145,60 @@ void DynamicAF::initialize_attackers()
 			symmetric_attacks.insert(make_pair(target, source));
 		}
 	}
+#if defined(DENSE_ENCODING)
+	initialize_groups();
+#endif
+}
+
+void DynamicAF::initialize_groups()
+{
+	groups.clear();
+	attacker_groups.clear();
+	ungrouped_attackers.clear();
+	dense = static_mode && args >= DENSE_BLOCK_SIZE && attacks.size() >= DENSE_MIN_DENSITY*args*args;
+	if (!dense) return;
+	// the attackers of an argument within each block of consecutive arguments form a pattern,
+	// and a pattern shared by enough arguments gets its own group variables
+	uint32_t blocks = (args + DENSE_BLOCK_SIZE - 1) / DENSE_BLOCK_SIZE;
+	vector<uint8_t> patterns(args * blocks);
+	for (uint32_t i = 0; i < args; i++) {
+		for (uint32_t j = 0; j < attackers[i].size(); j++) {
+			int32_t block = attackers[i][j] / DENSE_BLOCK_SIZE;
+			patterns[i * blocks + block] |= 1 << (attackers[i][j] % DENSE_BLOCK_SIZE);
+		}
+	}
+	vector<int32_t> uses(blocks << DENSE_BLOCK_SIZE);
+	for (uint32_t i = 0; i < args; i++) {
+		if (!arg_exists[i]) continue;
+		for (uint32_t block = 0; block < blocks; block++)
+			uses[(block << DENSE_BLOCK_SIZE) + patterns[i * blocks + block]]++;
+	}
+	vector<int32_t> group_of(blocks << DENSE_BLOCK_SIZE, -1);
+	for (uint32_t block = 0; block < blocks; block++) {
+		for (uint32_t pattern = 0; pattern < (1 << DENSE_BLOCK_SIZE); pattern++) {
+			// a group costs a clause per member and one more, and saves all but one per use
+			int32_t members = __builtin_popcount(pattern);
+			if (uses[(block << DENSE_BLOCK_SIZE) + pattern] * (members - 1) <= members + 1) continue;
+			group_of[(block << DENSE_BLOCK_SIZE) + pattern] = groups.size();
+			groups.push_back({});
+			for (int32_t k = 0; k < DENSE_BLOCK_SIZE; k++) {
+				if (pattern & (1 << k)) groups.back().push_back(block * DENSE_BLOCK_SIZE + k);
+			}
+		}
+	}
+	attacker_groups.resize(args);
+	ungrouped_attackers.resize(args);
+	for (uint32_t i = 0; i < args; i++) {
+		for (uint32_t block = 0; block < blocks; block++) {
+			int32_t group = group_of[(block << DENSE_BLOCK_SIZE) + patterns[i * blocks + block]];
+			if (group >= 0) attacker_groups[i].push_back(group);
+		}
+		for (uint32_t j = 0; j < attackers[i].size(); j++) {
+			int32_t block = attackers[i][j] / DENSE_BLOCK_SIZE;
+			if (group_of[(block << DENSE_BLOCK_SIZE) + patterns[i * blocks + block]] < 0)
+				ungrouped_attackers[i].push_back(attackers[i][j]);
+		}
+	}
 }
 
 void DynamicAF::set_var_count()
@@ -149,6 +208,8 @@ void DynamicAF::set_var_count()
 			count = 2*args;
 		else
 			count = 3*args;
+		group_base = count;
+		count += 2*groups.size();
 	} else {
 		count = 4*args + 3*args*args;
 	}
@@ -32,6 +32,12 @@ using namespace std;
 
 namespace Encodings {
 
+// the lazy encoding leaves out the per-attack clauses instead of grouping them
+static bool grouped(const DynamicAF & af)
+{
+	return af.dense && !af.lazy;
+}
+
 void add_source_accepted_clauses(const DynamicAF & af, SAT_Solver * solver)
 {
 	if (af.static_mode) return;
@@ -55,6 +61,42 @@ void add_source_accepted_clauses(const DynamicAF & af, SAT_Solver * solver)
 	}
 }
 
+void add_group_accepted_clauses(const DynamicAF & af, SAT_Solver * solver)
+{
+	for (uint32_t g = 0; g < af.groups.size(); g++) {
+		for (uint32_t j = 0; j < af.groups[g].size(); j++) {
+			vector<int> clause = { af.group_accepted_var(g), -af.accepted_var(af.groups[g][j]) };
+			solver->add_clause(clause);
+		}
+	}
+	for (uint32_t g = 0; g < af.groups.size(); g++) {
+		vector<int> clause(af.groups[g].size() + 1);
+		for (uint32_t j = 0; j < af.groups[g].size(); j++) {
+			clause[j] = af.accepted_var(af.groups[g][j]);
+		}
+		clause[af.groups[g].size()] = -af.group_accepted_var(g);
+		solver->add_clause(clause);
+	}
+}
+
+void add_group_rejected_clauses(const DynamicAF & af, SAT_Solver * solver)
+{
+	for (uint32_t g = 0; g < af.groups.size(); g++) {
+		for (uint32_t j = 0; j < af.groups[g].size(); j++) {
+			vector<int> clause = { -af.group_rejected_var(g), af.rejected_var(af.groups[g][j]) };
+			solver->add_clause(clause);
+		}
+	}
+	for (uint32_t g = 0; g < af.groups.size(); g++) {
+		vector<int> clause(af.groups[g].size() + 1);
+		for (uint32_t j = 0; j < af.groups[g].size(); j++) {
+			clause[j] = -af.rejected_var(af.groups[g][j]);
+		}
+		clause[af.groups[g].size()] = af.group_rejected_var(g);
+		solver->add_clause(clause);
+	}
+}
+
 void add_rejected_clauses(const DynamicAF & af, SAT_Solver * solver)
 {
 	for (uint32_t i = 0; i < af.args; i++) {
@@ -62,8 +104,38 @@ void add_rejected_clauses(const DynamicAF & af, SAT_Solver * solver)
 		vector<int> additional_clause = { -af.rejected_var(i), -af.accepted_var(i) };
 		solver->add_clause(additional_clause);
 	}
-	if (af.static_mode) {
+	if (grouped(af)) {
+		// conflict-freeness follows from these clauses, and self-attackers still get a unit
+		add_group_accepted_clauses(af, solver);
 		for (uint32_t i = 0; i < af.args; i++) {
+			if (!af.arg_exists[i]) continue;
+			if (af.self_attack[i]) {
+				vector<int> clause = { -af.accepted_var(i) };
+				solver->add_clause(clause);
+			}
+			for (uint32_t j = 0; j < af.attacker_groups[i].size(); j++) {
+				vector<int> clause = { af.rejected_var(i), -af.group_accepted_var(af.attacker_groups[i][j]) };
+				solver->add_clause(clause);
+			}
+			for (uint32_t j = 0; j < af.ungrouped_attackers[i].size(); j++) {
+				vector<int> clause = { af.rejected_var(i), -af.accepted_var(af.ungrouped_attackers[i][j]) };
+				solver->add_clause(clause);
+			}
+		}
+		for (uint32_t i = 0; i < af.args; i++) {
+			if (!af.arg_exists[i]) continue;
+			vector<int> clause = { -af.rejected_var(i) };
+			for (uint32_t j = 0; j < af.attacker_groups[i].size(); j++) {
+				clause.push_back(af.group_accepted_var(af.attacker_groups[i][j]));
+			}
+			for (uint32_t j = 0; j < af.ungrouped_attackers[i].size(); j++) {
+				clause.push_back(af.accepted_var(af.ungrouped_attackers[i][j]));
+			}
+			solver->add_clause(clause);
+		}
+	} else if (af.static_mode) {
+		// the lazy encoding adds the clauses for single attacks when refining models
+		for (uint32_t i = 0; i < af.args && !af.lazy; i++) {
 			if (!af.arg_exists[i]) continue;
 			for (uint32_t j = 0; j < af.attackers[i].size(); j++) {
 				vector<int> clause = { af.rejected_var(i), -af.accepted_var(af.attackers[i][j]) };
@@ -128,13 +200,41 @@ void add_source_rejected_clauses(const DynamicAF & af, SAT_Solver * solver)
 void add_range(const DynamicAF & af, SAT_Solver * solver)
 {
 	if (af.sem == STG) {
-		if (af.static_mode) {
+		if (grouped(af)) {
 			for (uint32_t i = 0; i < af.args; i++) {
 				if (!af.arg_exists[i]) continue;
 				vector<int> clause = { af.range_var(i), -af.accepted_var(i) };
 				solver->add_clause(clause);
 			}
 			for (uint32_t i = 0; i < af.args; i++) {
+				if (!af.arg_exists[i]) continue;
+				for (uint32_t j = 0; j < af.attacker_groups[i].size(); j++) {
+					vector<int> clause = { af.range_var(i), -af.group_accepted_var(af.attacker_groups[i][j]) };
+					solver->add_clause(clause);
+				}
+				for (uint32_t j = 0; j < af.ungrouped_attackers[i].size(); j++) {
+					vector<int> clause = { af.range_var(i), -af.accepted_var(af.ungrouped_attackers[i][j]) };
+					solver->add_clause(clause);
+				}
+			}
+			for (uint32_t i = 0; i < af.args; i++) {
+				if (!af.arg_exists[i]) continue;
+				vector<int> clause = { af.accepted_var(i), -af.range_var(i) };
+				for (uint32_t j = 0; j < af.attacker_groups[i].size(); j++) {
+					clause.push_back(af.group_accepted_var(af.attacker_groups[i][j]));
+				}
+				for (uint32_t j = 0; j < af.ungrouped_attackers[i].size(); j++) {
+					clause.push_back(af.accepted_var(af.ungrouped_attackers[i][j]));
+				}
+				solver->add_clause(clause);
+			}
+		} else if (af.static_mode) {
+			for (uint32_t i = 0; i < af.args; i++) {
+				if (!af.arg_exists[i]) continue;
+				vector<int> clause = { af.range_var(i), -af.accepted_var(i) };
+				solver->add_clause(clause);
+			}
+			for (uint32_t i = 0; i < af.args && !af.lazy; i++) {
 				if (!af.arg_exists[i]) continue;
 				for (uint32_t j = 0; j < af.attackers[i].size(); j++) {
 					vector<int> clause = { af.range_var(i), -af.accepted_var(af.attackers[i][j]) };
@@ -187,10 +287,29 @@ void add_range(const DynamicAF & af, SAT_Solver * solver)
 
 void add_conflict_free(const DynamicAF & af, SAT_Solver * solver)
 {
-	if (af.static_mode) {
+	if (grouped(af)) {
+		add_group_accepted_clauses(af, solver);
+		for (uint32_t i = 0; i < af.args; i++) {
+			if (!af.arg_exists[i]) continue;
+			if (af.self_attack[i]) {
+				vector<int> clause = { -af.accepted_var(i) };
+				solver->add_clause(clause);
+			}
+			for (uint32_t j = 0; j < af.attacker_groups[i].size(); j++) {
+				vector<int> clause = { -af.accepted_var(i), -af.group_accepted_var(af.attacker_groups[i][j]) };
+				solver->add_clause(clause);
+			}
+			for (uint32_t j = 0; j < af.ungrouped_attackers[i].size(); j++) {
+				if ((int32_t)i == af.ungrouped_attackers[i][j]) continue;
+				vector<int> clause = { -af.accepted_var(i), -af.accepted_var(af.ungrouped_attackers[i][j]) };
+				solver->add_clause(clause);
+			}
+		}
+	} else if (af.static_mode) {
 		for (uint32_t i = 0; i < af.args; i++) {
 			if (!af.arg_exists[i]) continue;
 			for (uint32_t j = 0; j < af.attackers[i].size(); j++) {
+				if (af.lazy && (int32_t)i != af.attackers[i][j]) continue;
 				vector<int> clause;
 				if ((int32_t)i != af.attackers[i][j]) {
 					clause = { -af.accepted_var(i), -af.accepted_var(af.attackers[i][j]) };
@@ -221,10 +340,25 @@ void add_conflict_free(const DynamicAF & af, SAT_Solver * solver)
 
 void add_admissible(const DynamicAF & af, SAT_Solver * solver)
 {
-	add_conflict_free(af, solver);
+	if (!grouped(af)) add_conflict_free(af, solver);
 	add_rejected_clauses(af, solver);
-	if (af.static_mode) {
+	if (grouped(af)) {
+		add_group_rejected_clauses(af, solver);
 		for (uint32_t i = 0; i < af.args; i++) {
+			if (!af.arg_exists[i]) continue;
+			if (af.self_attack[i]) continue;
+			for (uint32_t j = 0; j < af.attacker_groups[i].size(); j++) {
+				vector<int> clause = { -af.accepted_var(i), af.group_rejected_var(af.attacker_groups[i][j]) };
+				solver->add_clause(clause);
+			}
+			for (uint32_t j = 0; j < af.ungrouped_attackers[i].size(); j++) {
+				if (af.symmetric_attacks.count(make_pair(af.ungrouped_attackers[i][j], i))) continue;
+				vector<int> clause = { -af.accepted_var(i), af.rejected_var(af.ungrouped_attackers[i][j]) };
+				solver->add_clause(clause);
+			}
+		}
+	} else if (af.static_mode) {
+		for (uint32_t i = 0; i < af.args && !af.lazy; i++) {
 			if (!af.arg_exists[i]) continue;
 			if (af.self_attack[i]) continue;
 			for (uint32_t j = 0; j < af.attackers[i].size(); j++) {
@@ -247,7 +381,19 @@ void add_complete(const DynamicAF & af, SAT_Solver * solver)
 {
 	add_admissible(af, solver);
 	add_source_rejected_clauses(af, solver);
-	if (af.static_mode) {
+	if (grouped(af)) {
+		for (uint32_t i = 0; i < af.args; i++) {
+			if (!af.arg_exists[i]) continue;
+			vector<int> clause = { af.accepted_var(i) };
+			for (uint32_t j = 0; j < af.attacker_groups[i].size(); j++) {
+				clause.push_back(-af.group_rejected_var(af.attacker_groups[i][j]));
+			}
+			for (uint32_t j = 0; j < af.ungrouped_attackers[i].size(); j++) {
+				clause.push_back(-af.rejected_var(af.ungrouped_attackers[i][j]));
+			}
+			solver->add_clause(clause);
+		}
+	} else if (af.static_mode) {
 		for (uint32_t i = 0; i < af.args; i++) {
 			if (!af.arg_exists[i]) continue;
 			vector<int> clause(af.attackers[i].size()+1);
@@ -277,7 +423,7 @@ void add_stable(const DynamicAF & af, SAT_Solver * solver)
 #elif defined(CO_IN_ST)
 	add_complete(af, solver);
 #else
-	add_conflict_free(af, solver);
+	if (!grouped(af)) add_conflict_free(af, solver);
 	add_rejected_clauses(af, solver);
 #endif
 	if (af.static_mode) {
@@ -294,14 +440,45 @@ void add_stable(const DynamicAF & af, SAT_Solver * solver)
 	}
 }
 
-int32_t add_target(DynamicAF & af, const vector<int32_t> & assumptions, SAT_Solver * solver)
+bool refine(const DynamicAF & af, SAT_Solver * solver)
+{
+	// add the clauses of the lazy encoding that the last model violates
+	vector<vector<int>> clauses;
+	for (uint32_t i = 0; i < af.args; i++) {
+		if (!af.arg_exists[i]) continue;
+		for (uint32_t j = 0; j < af.attackers[i].size(); j++) {
+			int32_t attacker = af.attackers[i][j];
+			if (af.sem == STG) {
+				if (solver->get_value(af.accepted_var(attacker)) && solver->get_value(af.accepted_var(i)))
+					clauses.push_back({ -af.accepted_var(i), -af.accepted_var(attacker) });
+				if (solver->get_value(af.accepted_var(attacker)) && solver->get_value(-af.range_var(i)))
+					clauses.push_back({ af.range_var(i), -af.accepted_var(attacker) });
+				continue;
+			}
+			if (solver->get_value(af.accepted_var(attacker)) && solver->get_value(-af.rejected_var(i)))
+				clauses.push_back({ af.rejected_var(i), -af.accepted_var(attacker) });
+			if (solver->get_value(af.accepted_var(i)) && solver->get_value(-af.rejected_var(attacker)))
+				clauses.push_back({ -af.accepted_var(i), af.rejected_var(attacker) });
+		}
+	}
+	for (uint32_t i = 0; i < clauses.size(); i++)
+		solver->add_clause(clauses[i]);
+	return !clauses.empty();
+}
+
+int32_t add_target(DynamicAF & af, const vector<int32_t> & assumptions, bool cred, SAT_Solver * solver)
 {
 	if (assumptions.size() == 0) return 0;
-	if (assumptions.size() == 1) return assumptions[0];
+	if (assumptions.size() == 1) return (cred ? assumptions[0] : -assumptions[0]);
+	// only the direction used under the returned assumption is encoded,
+	// so that the target can later be disabled by its negation as a unit
 	int32_t target_var = ++af.count;
-	for (uint32_t i = 0; i < assumptions.size(); i++) {
-		vector<int> clause = { -target_var, assumptions[i] };
-		solver->add_clause(clause);
+	if (cred) {
+		for (uint32_t i = 0; i < assumptions.size(); i++) {
+			vector<int> clause = { -target_var, assumptions[i] };
+			solver->add_clause(clause);
+		}
+		return target_var;
 	}
 	vector<int> clause(assumptions.size()+1);
 	clause[0] = target_var;
@@ -309,7 +486,7 @@ int32_t add_target(DynamicAF & af, const vector<int32_t> & assumptions, SAT_Solv
 		clause[i+1] = -assumptions[i];
 	}
 	solver->add_clause(clause);
-	return target_var;
+	return -target_var;
 }
 
-}
\ No newline at end of file
+}
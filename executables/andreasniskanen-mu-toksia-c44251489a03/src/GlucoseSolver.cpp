@@ -28,21 +28,31 @@
 
 #include "GlucoseSolver.h"
 
+#include <mtl/Sort.h>
+
 using namespace std;
 using namespace Glucose;
 
 GlucoseSolver::GlucoseSolver(int32_t n_vars, int32_t n_args)
 {
 	solver = new Solver();
+	solver->implicitBinaries = true;
+	solver->compactInPlace = true;
+	solver->ca.setHugePages(true);
 #if defined(INCREMENTAL)
 	solver->setIncrementalMode();
 	solver->initNbInitialVars(n_args);
+	solver->keepAssumptionTrail = true;
 #endif
 	decision_vars = n_args;
+	conflict_limit = -1;
+	propagation_limit = -1;
+	timed = false;
 }
 
 void GlucoseSolver::add_clause(const vector<int32_t> & clause)
 {
+	if (clause_log) clause_log->push_back(clause);
 	vec<Lit> lits(clause.size());
 	for (uint32_t i = 0; i < clause.size(); i++) {
 		int32_t var = abs(clause[i])-1;
@@ -50,7 +60,38 @@ void GlucoseSolver::add_clause(const vector<int32_t> & clause)
 			solver->newVar();
 		lits[i] = (clause[i] > 0) ? mkLit(var) : ~mkLit(var);
 	}
-	solver->addClause_(lits);
+	if (solver->decisionLevel() > 0 && !attach_above_root(lits))
+		solver->cancelUntil(0);
+	if (solver->decisionLevel() == 0)
+		solver->addClause_(lits);
+}
+
+bool GlucoseSolver::attach_above_root(vec<Lit> & lits)
+{
+	// a clause with two literals that are not false can be watched without
+	// touching the assumption levels kept from the previous call
+	if (!solver->okay()) return false;
+	sort(lits);
+	int32_t i, j, watched = 0;
+	Lit p = lit_Undef;
+	for (i = j = 0; i < lits.size(); i++) {
+		if (lits[i] == ~p || (solver->value(lits[i]) == l_True && solver->level(Glucose::var(lits[i])) == 0))
+			return true;
+		if (lits[i] == p) continue;
+		lits[j++] = p = lits[i];
+		if (solver->value(p) != l_False && watched < 2)
+			swap(lits[j-1], lits[watched++]);
+	}
+	lits.shrink(i-j);
+	if (watched < 2) return false;
+	if (lits.size() == 2 && solver->implicitBinaries) {
+		solver->attachBinary(lits[0], lits[1]);
+		return true;
+	}
+	CRef cr = solver->ca.alloc(lits, false);
+	solver->clauses.push(cr);
+	solver->attachClause(cr);
+	return true;
 }
 
 void GlucoseSolver::assume(int32_t lit)
@@ -61,14 +102,56 @@ void GlucoseSolver::assume(int32_t lit)
 	assumptions.push((lit > 0) ? mkLit(var) : ~mkLit(var));
 }
 
+bool GlucoseSolver::exhausted()
+{
+	return solver->asynch_interrupt
+		|| (conflict_limit >= 0 && solver->conflicts >= (uint64_t)conflict_limit)
+		|| (propagation_limit >= 0 && solver->propagations >= (uint64_t)propagation_limit)
+		|| (timed && chrono::steady_clock::now() >= deadline);
+}
+
 bool GlucoseSolver::solve()
 {
-	bool sat = solver->solve(assumptions);
+	// the decisions on assumptions shared with the previous call are kept
+	int32_t shared = 0;
+	while (shared < solver->decisionLevel() && shared < assumptions.size()
+		&& assumptions[shared] == solver->assumptions[shared])
+		shared++;
+	solver->cancelUntil(shared);
+	// models rejected by refine are dropped, so values keep referring to the last model returned
+	vec<lbool> accepted;
+	if (refine) solver->model.copyTo(accepted);
+	// budgets are only checked at restarts, so a deadline is enforced by solving in slices
+	lbool result;
+	while (true) {
+		solver->conflict_budget = conflict_limit;
+		solver->propagation_budget = propagation_limit;
+		if (timed) {
+			int64_t slice = solver->conflicts + SOLVE_SLICE_CONFLICTS;
+			if (conflict_limit < 0 || slice < conflict_limit)
+				solver->conflict_budget = slice;
+		}
+		result = solver->solveLimited(assumptions);
+		if (result == l_True && refine && refine()) continue;
+		if (result != l_Undef || exhausted()) break;
+	}
+	if (refine && result != l_True) accepted.moveTo(solver->model);
+	if (result == l_Undef) {
+		assumptions.clear();
+		throw SolveInterrupted();
+	}
+	bool sat = (result == l_True);
 	if (sat) {
 		assignment.clear();
 		for (int32_t i = 0; i < decision_vars; i++) {
 			assignment.push_back(solver->modelValue(i) == l_True ? 1 : 0);
 		}
+	} else {
+		core.clear();
+		for (int32_t i = 0; i < solver->conflict.size(); i++) {
+			int32_t var = Glucose::var(solver->conflict[i])+1;
+			core.push_back(sign(solver->conflict[i]) ? var : -var);
+		}
 	}
 	assumptions.clear();
 	return sat;
@@ -76,6 +159,7 @@ bool GlucoseSolver::solve()
 
 bool GlucoseSolver::propagate(vector<int32_t> & out_lits)
 {
+	solver->cancelUntil(0);
 	for (int32_t i = 0; i < assumptions.size(); i++) {
 		solver->newDecisionLevel();
 		solver->uncheckedEnqueue(assumptions[i]);
@@ -97,4 +181,107 @@ bool GlucoseSolver::get_value(int32_t lit)
 	int32_t var = abs(lit)-1;
 	lbool val = solver->modelValue(var);
 	return (lit > 0) ? val == l_True : val == l_False;
-}
\ No newline at end of file
+}
+void GlucoseSolver::simplify()
+{
+	solver->cancelUntil(0);
+	solver->simplify();
+}
+
+void GlucoseSolver::set_phase(int32_t lit)
+{
+	int32_t var = abs(lit)-1;
+	while (var >= solver->nVars())
+		solver->newVar();
+	solver->setPolarity(var, lit < 0);
+}
+
+void GlucoseSolver::set_activity(int32_t var, double activity)
+{
+	int32_t v = var-1;
+	while (v >= solver->nVars())
+		solver->newVar();
+	solver->activity[v] = activity*solver->var_inc;
+	if (solver->order_heap.inHeap(v))
+		solver->order_heap.update(v);
+}
+
+void GlucoseSolver::set_limits(int64_t conflicts, int64_t propagations, double seconds)
+{
+	solver->clearInterrupt();
+	conflict_limit = (conflicts < 0 ? -1 : solver->conflicts + conflicts);
+	propagation_limit = (propagations < 0 ? -1 : solver->propagations + propagations);
+	timed = (seconds >= 0);
+	if (timed) {
+		deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+	}
+}
+
+void GlucoseSolver::interrupt()
+{
+	solver->interrupt();
+}
+bool GlucoseSolver::push(int32_t lit)
+{
+	solver->newDecisionLevel();
+	if (!solver->okay()) return false;
+	if (lit) {
+		int32_t var = abs(lit)-1;
+		while (var >= solver->nVars())
+			solver->newVar();
+		Lit p = (lit > 0) ? mkLit(var) : ~mkLit(var);
+		if (solver->value(p) == l_False) return false;
+		if (solver->value(p) == l_Undef) solver->uncheckedEnqueue(p);
+	}
+	return solver->propagate() == CRef_Undef;
+}
+
+void GlucoseSolver::pop()
+{
+	solver->cancelUntil(solver->decisionLevel()-1);
+}
+
+int8_t GlucoseSolver::value(int32_t lit)
+{
+	int32_t var = abs(lit)-1;
+	if (var >= solver->nVars()) return 0;
+	lbool val = solver->value(var);
+	if (val == l_Undef) return 0;
+	return ((val == l_True) == (lit > 0)) ? 1 : -1;
+}
+
+uint32_t GlucoseSolver::trail_size()
+{
+	return solver->trail.size();
+}
+
+int32_t GlucoseSolver::trail_lit(uint32_t i)
+{
+	Lit p = solver->trail[i];
+	return sign(p) ? -(Glucose::var(p)+1) : Glucose::var(p)+1;
+}
+
+uint64_t GlucoseSolver::reserved_bytes()
+{
+	return solver->ca.reserved();
+}
+
+bool GlucoseSolver::huge_pages()
+{
+	return solver->ca.hugePages();
+}
+
+int32_t GlucoseSolver::binary_watches()
+{
+	return solver->nBinaryWatches();
+}
+
+int32_t GlucoseSolver::arena_binary_watches()
+{
+	return solver->nArenaBinaryWatches();
+}
+
+int32_t GlucoseSolver::arena_binaries()
+{
+	return solver->nArenaBinaries();
+}
@@ -0,0 +1,170 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "LocalSearch.h"
+
+#include <random>
+
+#define NOISE_PERCENT 20
+
+using namespace std;
+
+namespace LocalSearch {
+
+struct State {
+	vector<vector<int32_t>> targets;
+	vector<uint8_t> in;
+	vector<uint32_t> in_attackers;
+	vector<int32_t> violated;
+	vector<int32_t> position;
+
+	// an argument in the extension must not be attacked by it, one outside must be
+	bool is_violated(int32_t a, bool a_in, uint32_t attackers_in) const
+	{
+		return a_in ? attackers_in > 0 : attackers_in == 0;
+	}
+
+	void update(int32_t a)
+	{
+		bool v = is_violated(a, in[a], in_attackers[a]);
+		if (v && position[a] < 0) {
+			position[a] = violated.size();
+			violated.push_back(a);
+		} else if (!v && position[a] >= 0) {
+			int32_t last = violated.back();
+			violated[position[a]] = last;
+			position[last] = position[a];
+			violated.pop_back();
+			position[a] = -1;
+		}
+	}
+
+	int32_t delta(int32_t a) const
+	{
+		bool a_in = !in[a];
+		int32_t d = (int32_t)is_violated(a, a_in, in_attackers[a]) - (int32_t)is_violated(a, in[a], in_attackers[a]);
+		for (uint32_t i = 0; i < targets[a].size(); i++) {
+			int32_t t = targets[a][i];
+			uint32_t c = (a_in ? in_attackers[t]+1 : in_attackers[t]-1);
+			d += (int32_t)is_violated(t, in[t], c) - (int32_t)is_violated(t, in[t], in_attackers[t]);
+		}
+		return d;
+	}
+
+	void flip(int32_t a)
+	{
+		in[a] = !in[a];
+		for (uint32_t i = 0; i < targets[a].size(); i++) {
+			int32_t t = targets[a][i];
+			if (in[a]) in_attackers[t]++;
+			else in_attackers[t]--;
+			update(t);
+		}
+		update(a);
+	}
+};
+
+bool stable(const DynamicAF & af, const vector<int32_t> & lits, uint64_t max_flips, vector<uint8_t> & labelling)
+{
+	labelling.clear();
+	// -1: free, 0: fixed out, 1: fixed in
+	vector<int8_t> fixed(af.args, -1);
+	for (uint32_t i = 0; i < af.args; i++) {
+		if (!af.arg_exists[i] || af.self_attack[i]) fixed[i] = 0;
+	}
+	for (uint32_t i = 0; i < lits.size(); i++) {
+		int32_t var = abs(lits[i]);
+		bool accepted = (var <= (int32_t)af.args);
+		int32_t arg = (accepted ? var-1 : var-af.args-1);
+		int8_t value = (accepted == (lits[i] > 0));
+		if (fixed[arg] >= 0 && fixed[arg] != value) return false;
+		fixed[arg] = value;
+	}
+
+	State state;
+	state.targets.resize(af.args);
+	for (uint32_t i = 0; i < af.args; i++) {
+		if (!af.arg_exists[i]) continue;
+		for (uint32_t j = 0; j < af.attackers[i].size(); j++)
+			state.targets[af.attackers[i][j]].push_back(i);
+	}
+	state.in.assign(af.args, 0);
+	state.in_attackers.assign(af.args, 0);
+	state.position.assign(af.args, -1);
+
+	mt19937 rng(af.version);
+	for (uint32_t i = 0; i < af.args; i++) {
+		if (fixed[i] == 1 || (fixed[i] < 0 && rng() % 2)) state.flip(i);
+	}
+	for (uint32_t i = 0; i < af.args; i++) {
+		if (af.arg_exists[i]) state.update(i);
+	}
+
+	vector<uint8_t> best = state.in;
+	uint32_t best_violated = state.violated.size();
+	vector<int32_t> candidates;
+	for (uint64_t flips = 0; flips < max_flips && !state.violated.empty(); flips++) {
+		int32_t a = state.violated[rng() % state.violated.size()];
+		// a violation is repaired by flipping the argument itself, or by taking an
+		// attacker out (if the argument is in) or in (if it is out and unattacked)
+		candidates.clear();
+		if (fixed[a] < 0) candidates.push_back(a);
+		for (uint32_t i = 0; i < af.attackers[a].size(); i++) {
+			int32_t b = af.attackers[a][i];
+			if (fixed[b] < 0 && state.in[b] == state.in[a]) candidates.push_back(b);
+		}
+		if (candidates.empty()) continue;
+		int32_t choice = candidates[rng() % candidates.size()];
+		if (rng() % 100 >= NOISE_PERCENT) {
+			int32_t best_delta = state.delta(choice);
+			for (uint32_t i = 0; i < candidates.size(); i++) {
+				int32_t d = state.delta(candidates[i]);
+				if (d < best_delta) {
+					best_delta = d;
+					choice = candidates[i];
+				}
+			}
+		}
+		state.flip(choice);
+		if (state.violated.size() < best_violated) {
+			best_violated = state.violated.size();
+			best = state.in;
+		}
+	}
+	if (state.violated.empty()) best = state.in;
+
+	labelling.assign(2*af.args, 0);
+	for (uint32_t i = 0; i < af.args; i++) {
+		labelling[af.accepted_var(i)-1] = best[i];
+		for (uint32_t j = 0; j < af.attackers[i].size() && !labelling[af.rejected_var(i)-1]; j++)
+			labelling[af.rejected_var(i)-1] = best[af.attackers[i][j]];
+	}
+	return state.violated.empty();
+}
+
+}
@@ -46,6 +46,7 @@ static int version_flag = 0;
 static int usage_flag = 0;
 static int formats_flag = 0;
 static int problems_flag = 0;
+static int verbose_flag = 0;
 
 task string_to_task(string problem)
 {
@@ -82,6 +83,7 @@ void print_usage(string solver_name)
 	cout << "  --version   Prints version and author information.\n";
 	cout << "  --formats   Prints available file formats.\n";
 	cout << "  --problems  Prints available computational tasks.\n";
+	cout << "  --verbose   Prints solver statistics as comment lines after the answer.\n";
 }
 
 void print_version(string solver_name)
@@ -125,6 +127,7 @@ int main(int argc, char ** argv)
 		{"version", no_argument, &version_flag, 1},
 		{"formats", no_argument, &formats_flag, 1},
 		{"problems", no_argument, &problems_flag, 1},
+		{"verbose", no_argument, &verbose_flag, 1},
 		{"p", required_argument, 0, 'p'},
 		{"f", required_argument, 0, 'f'},
 		{"fo", required_argument, 0, 'o'},
@@ -334,6 +337,7 @@ int main(int argc, char ** argv)
 			return 1;
 
 	}
+	if (verbose_flag) solver.print_stats();
 	auto end = std::chrono::high_resolution_clock::now();
 	auto duration = std::chrono::duration<double>(end - start).count();
 	if(string_to_task(task)==DC){
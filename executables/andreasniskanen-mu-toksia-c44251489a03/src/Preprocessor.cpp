@@ -0,0 +1,370 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Preprocessor.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+// clauses are kept sorted by variable, so that the literals of a variable are adjacent
+static bool lit_less(int32_t a, int32_t b)
+{
+	return abs(a) < abs(b) || (abs(a) == abs(b) && a < b);
+}
+
+static int32_t index_lit(uint32_t index)
+{
+	return (index & 1) ? -(int32_t)(index >> 1) : (int32_t)(index >> 1);
+}
+
+Preprocessor::Preprocessor(vector<vector<int32_t>> & clauses, uint32_t n_frozen)
+	: clauses(clauses), frozen(n_frozen), vars(n_frozen), unsat(false), steps(0)
+{
+	for (uint32_t c = 0; c < clauses.size(); c++) {
+		for (uint32_t i = 0; i < clauses[c].size(); i++)
+			vars = max<uint32_t>(vars, abs(clauses[c][i]));
+	}
+	occurs.resize(2*vars+2);
+	value.assign(vars+1, 0);
+	eliminated.assign(vars+1, 0);
+	vector<vector<int32_t>> original;
+	original.swap(clauses);
+	for (uint32_t c = 0; c < original.size(); c++) add(original[c]);
+}
+
+bool Preprocessor::contains(uint32_t c, int32_t lit) const
+{
+	return binary_search(clauses[c].begin(), clauses[c].end(), lit, lit_less);
+}
+
+void Preprocessor::add(vector<int32_t> & clause)
+{
+	// false literals are dropped, and satisfied or tautological clauses are not added
+	uint32_t j = 0;
+	for (uint32_t i = 0; i < clause.size(); i++) {
+		int32_t lit = clause[i];
+		int8_t val = value[abs(lit)];
+		if (!val) clause[j++] = lit;
+		else if ((val > 0) == (lit > 0)) return;
+	}
+	clause.resize(j);
+	sort(clause.begin(), clause.end(), lit_less);
+	clause.erase(unique(clause.begin(), clause.end()), clause.end());
+	for (uint32_t i = 1; i < clause.size(); i++) {
+		if (clause[i] == -clause[i-1]) return;
+	}
+	if (clause.empty()) {
+		unsat = true;
+		return;
+	}
+	for (uint32_t i = 0; i < clause.size(); i++) occurs[index(clause[i])].push_back(clauses.size());
+	if (clause.size() == 1) units.push_back(clause[0]);
+	clauses.push_back(clause);
+	removed.push_back(false);
+}
+
+void Preprocessor::strengthen(uint32_t c, int32_t lit)
+{
+	vector<int32_t> & clause = clauses[c];
+	clause.erase(find(clause.begin(), clause.end(), lit));
+	if (clause.empty()) unsat = true;
+	else if (clause.size() == 1) units.push_back(clause[0]);
+}
+
+bool Preprocessor::propagate()
+{
+	while (!units.empty() && !unsat) {
+		int32_t lit = units.back();
+		units.pop_back();
+		int8_t & val = value[abs(lit)];
+		if (val) {
+			if ((val > 0) != (lit > 0)) unsat = true;
+			continue;
+		}
+		val = (lit > 0) ? 1 : -1;
+		for (uint32_t i = 0; i < occurs[index(lit)].size(); i++) {
+			uint32_t c = occurs[index(lit)][i];
+			if (!removed[c] && contains(c, lit)) removed[c] = true;
+		}
+		for (uint32_t i = 0; i < occurs[index(-lit)].size(); i++) {
+			uint32_t c = occurs[index(-lit)][i];
+			if (!removed[c] && contains(c, -lit)) strengthen(c, -lit);
+		}
+		occurs[index(lit)].clear();
+		occurs[index(-lit)].clear();
+	}
+	return !unsat;
+}
+
+bool Preprocessor::substitute()
+{
+	// SCCs of the binary implication graph over literal indices, by Tarjan's algorithm
+	const uint32_t none = UINT32_MAX;
+	uint32_t nodes = 2*vars+2;
+	vector<vector<uint32_t>> implied(nodes);
+	for (uint32_t c = 0; c < clauses.size(); c++) {
+		if (removed[c] || clauses[c].size() != 2) continue;
+		implied[index(-clauses[c][0])].push_back(index(clauses[c][1]));
+		implied[index(-clauses[c][1])].push_back(index(clauses[c][0]));
+	}
+	vector<uint32_t> order(nodes, none), low(nodes), stack, scc;
+	vector<uint8_t> on_stack(nodes);
+	vector<pair<uint32_t,uint32_t>> calls;
+	vector<int32_t> substitute(vars+1, 0);
+	bool substituted = false;
+	uint32_t next = 0;
+	for (uint32_t root = 2; root < nodes && !unsat; root++) {
+		if (order[root] != none || implied[root].empty()) continue;
+		calls.push_back(make_pair(root, 0));
+		order[root] = low[root] = next++;
+		stack.push_back(root);
+		on_stack[root] = true;
+		while (!calls.empty()) {
+			uint32_t u = calls.back().first;
+			uint32_t & i = calls.back().second;
+			if (i < implied[u].size()) {
+				uint32_t w = implied[u][i++];
+				if (order[w] == none) {
+					order[w] = low[w] = next++;
+					stack.push_back(w);
+					on_stack[w] = true;
+					calls.push_back(make_pair(w, 0));
+				} else if (on_stack[w]) {
+					low[u] = min(low[u], order[w]);
+				}
+				continue;
+			}
+			calls.pop_back();
+			if (!calls.empty()) low[calls.back().first] = min(low[calls.back().first], low[u]);
+			if (low[u] != order[u]) continue;
+			scc.clear();
+			uint32_t w;
+			do {
+				w = stack.back();
+				stack.pop_back();
+				on_stack[w] = false;
+				scc.push_back(w);
+			} while (w != u);
+			if (scc.size() == 1) continue;
+			// the representative is the smallest frozen variable, or else the smallest one,
+			// which the complementary SCC picks negated
+			// an SCC holding both literals of a variable makes the formula unsatisfiable
+			sort(scc.begin(), scc.end());
+			for (uint32_t k = 1; k < scc.size(); k++) {
+				if ((scc[k] >> 1) == (scc[k-1] >> 1)) unsat = true;
+			}
+			int32_t rep = index_lit(scc[0]);
+			for (uint32_t k = 0; k < scc.size(); k++) {
+				int32_t lit = index_lit(scc[k]);
+				bool lit_frozen = (uint32_t)abs(lit) <= frozen, rep_frozen = (uint32_t)abs(rep) <= frozen;
+				if ((lit_frozen && !rep_frozen) || (lit_frozen == rep_frozen && abs(lit) < abs(rep))) rep = lit;
+			}
+			for (uint32_t k = 0; k < scc.size(); k++) {
+				int32_t lit = index_lit(scc[k]);
+				if ((uint32_t)abs(lit) <= frozen || lit == rep) continue;
+				substitute[abs(lit)] = (lit > 0) ? rep : -rep;
+				substituted = true;
+			}
+		}
+	}
+	if (unsat || !substituted) return false;
+	uint32_t n_clauses = clauses.size();
+	for (uint32_t c = 0; c < n_clauses; c++) {
+		if (removed[c]) continue;
+		bool affected = false;
+		for (uint32_t i = 0; i < clauses[c].size() && !affected; i++) affected = substitute[abs(clauses[c][i])];
+		if (!affected) continue;
+		removed[c] = true;
+		vector<int32_t> clause = clauses[c];
+		for (uint32_t i = 0; i < clause.size(); i++) {
+			int32_t sub = substitute[abs(clause[i])];
+			if (sub) clause[i] = (clause[i] > 0) ? sub : -sub;
+		}
+		add(clause);
+	}
+	for (uint32_t v = 1; v <= vars; v++) {
+		if (!substitute[v]) continue;
+		eliminated[v] = true;
+		occurs[index(v)].clear();
+		occurs[index(-v)].clear();
+	}
+	return true;
+}
+
+void Preprocessor::subsume()
+{
+	vector<uint32_t> order;
+	for (uint32_t c = 0; c < clauses.size(); c++) {
+		if (!removed[c]) order.push_back(c);
+	}
+	stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return clauses[a].size() < clauses[b].size(); });
+	for (uint32_t k = 0; k < order.size() && steps < PREPROCESS_STEPS && !unsat; k++) {
+		uint32_t c = order[k];
+		if (removed[c]) continue;
+		const vector<int32_t> & clause = clauses[c];
+		// clauses containing this one are among the occurrences of its rarest literal
+		int32_t rarest = clause[0];
+		for (uint32_t i = 1; i < clause.size(); i++) {
+			if (occurs[index(clause[i])].size() < occurs[index(rarest)].size()) rarest = clause[i];
+		}
+		const vector<uint32_t> & candidates = occurs[index(rarest)];
+		for (uint32_t j = 0; j < candidates.size(); j++) {
+			uint32_t d = candidates[j];
+			if (d == c || removed[d] || clauses[d].size() < clause.size()) continue;
+			steps += clause.size();
+			bool subsumed = true;
+			for (uint32_t i = 0; i < clause.size() && subsumed; i++) subsumed = contains(d, clause[i]);
+			if (subsumed) removed[d] = true;
+		}
+		// self-subsuming resolution drops the negation of a literal from a clause
+		// that contains the rest of this one
+		for (uint32_t l = 0; l < clause.size(); l++) {
+			const vector<uint32_t> & strengthened = occurs[index(-clause[l])];
+			for (uint32_t j = 0; j < strengthened.size(); j++) {
+				uint32_t d = strengthened[j];
+				if (d == c || removed[d] || clauses[d].size() < clause.size()) continue;
+				steps += clause.size();
+				bool subsumed = contains(d, -clause[l]);
+				for (uint32_t i = 0; i < clause.size() && subsumed; i++) subsumed = (i == l || contains(d, clause[i]));
+				if (subsumed) strengthen(d, -clause[l]);
+			}
+		}
+	}
+	propagate();
+}
+
+bool Preprocessor::resolve(const vector<int32_t> & pos, const vector<int32_t> & neg, int32_t lit, vector<int32_t> & out)
+{
+	// merges the sorted clauses without lit, and fails on a tautology
+	out.clear();
+	uint32_t i = 0, j = 0;
+	while (i < pos.size() || j < neg.size()) {
+		int32_t next = (j == neg.size() || (i < pos.size() && lit_less(pos[i], neg[j]))) ? pos[i++] : neg[j++];
+		if (abs(next) == abs(lit)) continue;
+		if (!out.empty() && out.back() == next) continue;
+		if (!out.empty() && out.back() == -next) return false;
+		out.push_back(next);
+	}
+	return true;
+}
+
+bool Preprocessor::eliminate(uint32_t var)
+{
+	if (var <= frozen || value[var] || eliminated[var]) return false;
+	int32_t lit = var;
+	vector<uint32_t> pos, neg;
+	for (uint32_t i = 0; i < occurs[index(lit)].size(); i++) {
+		uint32_t c = occurs[index(lit)][i];
+		if (!removed[c] && contains(c, lit)) pos.push_back(c);
+	}
+	for (uint32_t i = 0; i < occurs[index(-lit)].size(); i++) {
+		uint32_t c = occurs[index(-lit)][i];
+		if (!removed[c] && contains(c, -lit)) neg.push_back(c);
+	}
+	// the variable goes if its non-tautological resolvents are no more than its clauses
+	vector<vector<int32_t>> resolvents;
+	vector<int32_t> resolvent;
+	for (uint32_t i = 0; i < pos.size(); i++) {
+		for (uint32_t j = 0; j < neg.size(); j++) {
+			steps += clauses[pos[i]].size() + clauses[neg[j]].size();
+			if (!resolve(clauses[pos[i]], clauses[neg[j]], lit, resolvent)) continue;
+			resolvents.push_back(resolvent);
+			if (resolvents.size() > pos.size() + neg.size() || steps >= PREPROCESS_STEPS) return false;
+		}
+	}
+	for (uint32_t i = 0; i < pos.size(); i++) removed[pos[i]] = true;
+	for (uint32_t j = 0; j < neg.size(); j++) removed[neg[j]] = true;
+	eliminated[var] = true;
+	occurs[index(lit)].clear();
+	occurs[index(-lit)].clear();
+	for (uint32_t i = 0; i < resolvents.size(); i++) add(resolvents[i]);
+	return true;
+}
+
+void Preprocessor::renumber()
+{
+	renamed.assign(vars+1, 0);
+	vector<uint8_t> used(vars+1);
+	for (uint32_t c = 0; c < clauses.size(); c++) {
+		if (removed[c]) continue;
+		for (uint32_t i = 0; i < clauses[c].size(); i++) used[abs(clauses[c][i])] = true;
+	}
+	uint32_t n_vars = frozen;
+	for (uint32_t v = 1; v <= vars; v++) {
+		if (v <= frozen) renamed[v] = v;
+		else if (used[v]) renamed[v] = ++n_vars;
+	}
+	vector<vector<int32_t>> simplified;
+	if (unsat) {
+		simplified.push_back(vector<int32_t>());
+	} else {
+		// the frozen variables fixed by propagation are kept as units
+		for (uint32_t v = 1; v <= frozen; v++) {
+			if (value[v]) simplified.push_back(vector<int32_t>(1, value[v] > 0 ? (int32_t)v : -(int32_t)v));
+		}
+		for (uint32_t c = 0; c < clauses.size(); c++) {
+			if (removed[c]) continue;
+			vector<int32_t> clause(clauses[c]);
+			for (uint32_t i = 0; i < clause.size(); i++) {
+				int32_t var = renamed[abs(clause[i])];
+				clause[i] = (clause[i] > 0) ? var : -var;
+			}
+			simplified.push_back(clause);
+		}
+	}
+	clauses.swap(simplified);
+	vars = n_vars;
+}
+
+uint32_t Preprocessor::simplify()
+{
+	for (uint32_t round = 0; round < PREPROCESS_ROUNDS && !unsat; round++) {
+		propagate();
+		bool changed = substitute();
+		propagate();
+		subsume();
+		// variables with few occurrences first, as their resolvents are cheapest
+		vector<uint32_t> candidates;
+		for (uint32_t v = frozen+1; v <= vars; v++) {
+			if (!value[v] && !eliminated[v]) candidates.push_back(v);
+		}
+		sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+			return occurs[index(a)].size()*occurs[index(-(int32_t)a)].size() < occurs[index(b)].size()*occurs[index(-(int32_t)b)].size();
+		});
+		for (uint32_t i = 0; i < candidates.size() && steps < PREPROCESS_STEPS && !unsat; i++) {
+			if (eliminate(candidates[i])) changed = true;
+			propagate();
+		}
+		if (!changed) break;
+	}
+	propagate();
+	renumber();
+	return vars;
+}
@@ -0,0 +1,365 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "SmallAF.h"
+
+#include <cstdlib>
+
+#define SMALL_AF_NODE_LIMIT 16384
+
+using namespace std;
+
+namespace SmallAF {
+
+template <uint32_t W>
+struct Bitset {
+	uint64_t words[W];
+
+	Bitset() { for (uint32_t k = 0; k < W; k++) words[k] = 0; }
+
+	void set(uint32_t i) { words[i >> 6] |= 1ULL << (i & 63); }
+	bool test(uint32_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+	bool any() const
+	{
+		uint64_t bits = 0;
+		for (uint32_t k = 0; k < W; k++) bits |= words[k];
+		return bits != 0;
+	}
+
+	uint32_t count() const
+	{
+		uint32_t c = 0;
+		for (uint32_t k = 0; k < W; k++) c += __builtin_popcountll(words[k]);
+		return c;
+	}
+
+	int32_t first() const
+	{
+		for (uint32_t k = 0; k < W; k++) {
+			if (words[k]) return 64*k + __builtin_ctzll(words[k]);
+		}
+		return -1;
+	}
+
+	template <class F>
+	void for_each(F f) const
+	{
+		for (uint32_t k = 0; k < W; k++) {
+			for (uint64_t bits = words[k]; bits; bits &= bits - 1)
+				f(64*k + __builtin_ctzll(bits));
+		}
+	}
+
+	Bitset operator|(const Bitset & other) const
+	{
+		Bitset result;
+		for (uint32_t k = 0; k < W; k++) result.words[k] = words[k] | other.words[k];
+		return result;
+	}
+
+	Bitset operator&(const Bitset & other) const
+	{
+		Bitset result;
+		for (uint32_t k = 0; k < W; k++) result.words[k] = words[k] & other.words[k];
+		return result;
+	}
+
+	Bitset without(const Bitset & other) const
+	{
+		Bitset result;
+		for (uint32_t k = 0; k < W; k++) result.words[k] = words[k] & ~other.words[k];
+		return result;
+	}
+
+	bool operator==(const Bitset & other) const
+	{
+		for (uint32_t k = 0; k < W; k++) {
+			if (words[k] != other.words[k]) return false;
+		}
+		return true;
+	}
+
+	bool subset_of(const Bitset & other) const { return !without(other).any(); }
+};
+
+enum kind { CONFLICT_FREE, ADMISSIBLE, COMPLETE };
+
+template <uint32_t W>
+struct Engine {
+	typedef Bitset<W> Set;
+
+	// conditions on the extension searched for, over positions of existing arguments
+	struct Query {
+		Set in;
+		Set out;
+		Set attacked;
+		Set unattacked;
+		// each of these is in the extension or attacked by it
+		Set cover;
+	};
+
+	const DynamicAF & af;
+	vector<int32_t> arg;
+	vector<int32_t> position;
+	vector<Set> attackers;
+	vector<Set> targets;
+	Set all;
+	Set self;
+	uint64_t nodes;
+	bool gave_up;
+
+	Engine(const DynamicAF & framework) : af(framework), nodes(0), gave_up(false)
+	{
+		position.assign(af.args, -1);
+		for (uint32_t i = 0; i < af.args; i++) {
+			if (!af.arg_exists[i]) continue;
+			position[i] = arg.size();
+			arg.push_back(i);
+		}
+		attackers.resize(arg.size());
+		targets.resize(arg.size());
+		for (uint32_t p = 0; p < arg.size(); p++) {
+			all.set(p);
+			for (uint32_t j = 0; j < af.attackers[arg[p]].size(); j++) {
+				int32_t q = position[af.attackers[arg[p]][j]];
+				attackers[p].set(q);
+				targets[q].set(p);
+			}
+			if (af.self_attack[arg[p]]) self.set(p);
+		}
+	}
+
+	Set attacked_by(const Set & s) const
+	{
+		Set result;
+		s.for_each([&](uint32_t p) { result = result | targets[p]; });
+		return result;
+	}
+
+	Set attacking(const Set & s) const
+	{
+		Set result;
+		s.for_each([&](uint32_t p) { result = result | attackers[p]; });
+		return result;
+	}
+
+	Set defended_by(const Set & plus) const
+	{
+		Set result;
+		all.for_each([&](uint32_t p) { if (attackers[p].subset_of(plus)) result.set(p); });
+		return result;
+	}
+
+	void add_literal(Query & q, int32_t lit) const
+	{
+		int32_t var = abs(lit);
+		bool accepted = (var <= (int32_t)af.args);
+		int32_t p = position[accepted ? var-1 : var-af.args-1];
+		if (accepted) (lit > 0 ? q.in : q.out).set(p);
+		else (lit > 0 ? q.attacked : q.unattacked).set(p);
+	}
+
+	// extends in and excl by what every extension of the given kind between them must contain,
+	// and returns false if there is none
+	bool propagate(kind k, const Query & q, Set & in, Set & excl) const
+	{
+		while (true) {
+			Set plus = attacked_by(in);
+			Set minus = attacking(in);
+			if ((in & (plus | self | q.out)).any() || (plus & q.unattacked).any()) return false;
+			excl = excl | all.without(in) & (plus | minus | self | q.out);
+			Set possible = all.without(excl);
+			// arguments to be attacked, with a single possible attacker taken in
+			Set need = q.attacked | q.cover.without(possible);
+			if (k != CONFLICT_FREE) need = need | minus;
+			Set forced;
+			bool conflict = false;
+			need.without(plus).for_each([&](uint32_t p) {
+				Set candidates = attackers[p] & possible;
+				if (!candidates.any()) conflict = true;
+				else if (candidates.count() == 1) forced = forced | candidates;
+			});
+			if (conflict) return false;
+			if (k == COMPLETE) {
+				Set defended = defended_by(plus);
+				if ((defended & excl).any()) return false;
+				forced = forced | defended;
+			}
+			if (!forced.without(in).any()) return true;
+			in = in | forced;
+		}
+	}
+
+	// calls accept on the extensions of the given kind satisfying q until it returns true
+	template <class F>
+	bool search(kind k, const Query & q, Set in, Set excl, F & accept)
+	{
+		if (gave_up || ++nodes > SMALL_AF_NODE_LIMIT) {
+			gave_up = true;
+			return false;
+		}
+		if (!propagate(k, q, in, excl)) return false;
+		int32_t p = all.without(in | excl).first();
+		if (p < 0) return accept(in);
+		Set branch;
+		branch.set(p);
+		if (search(k, q, in | branch, excl, accept)) return true;
+		return search(k, q, in, excl | branch, accept);
+	}
+
+	template <class F>
+	bool search(kind k, const Query & q, F accept)
+	{
+		return search(k, q, q.in, q.out | attacking(q.unattacked), accept);
+	}
+
+	bool preferred(const Set & s)
+	{
+		Query larger;
+		larger.in = s;
+		return !search(ADMISSIBLE, larger, [&](const Set & t) { return !(t == s); });
+	}
+
+	bool maximal_range(kind k, const Set & s)
+	{
+		Set range = s | attacked_by(s);
+		Query larger;
+		larger.cover = range;
+		return !search(k, larger, [&](const Set & t) { return !(range == (t | attacked_by(t))); });
+	}
+
+	bool naive(const Set & s) const
+	{
+		return !all.without(s | attacked_by(s) | attacking(s) | self).any();
+	}
+
+	bool find(const Query & q, Set & extension)
+	{
+		auto found = [&](const Set & s) { extension = s; return true; };
+		switch (af.sem) {
+			case AD:
+				return search(ADMISSIBLE, q, found);
+			case CO:
+				return search(COMPLETE, q, found);
+			case ST: {
+				Query stable = q;
+				stable.cover = all;
+				return search(COMPLETE, stable, found);
+			}
+			case PR:
+				return search(COMPLETE, q, [&](const Set & s) { return preferred(s) && found(s); });
+			case SST:
+				return search(COMPLETE, q, [&](const Set & s) { return maximal_range(ADMISSIBLE, s) && found(s); });
+			case STG:
+				return search(CONFLICT_FREE, q, [&](const Set & s) { return naive(s) && maximal_range(CONFLICT_FREE, s) && found(s); });
+			default:
+				return false;
+		}
+	}
+
+	Set ideal()
+	{
+		// arguments attacked by some admissible set are in no ideal set
+		Set rejected;
+		all.for_each([&](uint32_t p) {
+			if (rejected.test(p)) return;
+			Query q;
+			q.attacked.set(p);
+			search(ADMISSIBLE, q, [&](const Set & s) { rejected = rejected | attacked_by(s); return true; });
+		});
+		// the ideal extension is the largest admissible set of non-rejected arguments
+		Set in = all.without(rejected);
+		all.without(rejected).for_each([&](uint32_t p) {
+			Set unrejected = attackers[p].without(rejected);
+			if (!unrejected.any()) return;
+			Set attack = unrejected;
+			attack.set(p);
+			in = in.without(attack);
+		});
+		while (true) {
+			Set defended = in & defended_by(attacked_by(in));
+			if (defended == in) return in;
+			in = defended;
+		}
+	}
+
+	void label(const Set & s, vector<uint8_t> & witness) const
+	{
+		Set plus = attacked_by(s);
+		witness.assign(2*af.args, 0);
+		for (uint32_t p = 0; p < arg.size(); p++) {
+			witness[af.accepted_var(arg[p])-1] = s.test(p);
+			witness[af.rejected_var(arg[p])-1] = plus.test(p);
+		}
+	}
+
+	int decide(const vector<int32_t> & lits, bool cred, vector<uint8_t> & witness)
+	{
+		Set extension;
+		if (af.sem == ID) {
+			extension = ideal();
+			if (gave_up) return -1;
+			label(extension, witness);
+			for (uint32_t i = 0; i < lits.size(); i++) {
+				if (witness[abs(lits[i])-1] != (lits[i] > 0)) return 0;
+			}
+			return 1;
+		}
+		if (cred) {
+			Query q;
+			for (uint32_t i = 0; i < lits.size(); i++)
+				add_literal(q, lits[i]);
+			bool found = find(q, extension);
+			if (gave_up) return -1;
+			if (found) label(extension, witness);
+			return found;
+		}
+		// a counterexample falsifies one of the literals
+		for (uint32_t i = 0; i < lits.size(); i++) {
+			Query q;
+			add_literal(q, -lits[i]);
+			bool found = find(q, extension);
+			if (gave_up) return -1;
+			if (found) {
+				label(extension, witness);
+				return 0;
+			}
+		}
+		return 1;
+	}
+};
+
+int decide(const DynamicAF & af, const vector<int32_t> & lits, bool cred, vector<uint8_t> & witness)
+{
+	if (af.arg_to_int.size() <= 64)
+		return Engine<1>(af).decide(lits, cred, witness);
+	return Engine<2>(af).decide(lits, cred, witness);
+}
+
+}
@@ -0,0 +1,90 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "Totalizer.h"
+
+using namespace std;
+
+Totalizer::Totalizer(const vector<int32_t> & inputs)
+{
+	nodes.reserve(2*inputs.size());
+	nodes.push_back(Node());
+	build(inputs, 0, inputs.size());
+}
+
+int32_t Totalizer::build(const vector<int32_t> & inputs, uint32_t begin, uint32_t end)
+{
+	int32_t node = nodes.size()-1;
+	nodes[node].leaves = end-begin;
+	if (end-begin == 1) {
+		nodes[node].left = nodes[node].right = -1;
+		nodes[node].outputs.push_back(inputs[begin]);
+		return node;
+	}
+	uint32_t middle = begin+(end-begin)/2;
+	nodes.push_back(Node());
+	int32_t left = build(inputs, begin, middle);
+	nodes.push_back(Node());
+	int32_t right = build(inputs, middle, end);
+	nodes[node].left = left;
+	nodes[node].right = right;
+	return node;
+}
+
+void Totalizer::extend(int32_t node, uint32_t k, DynamicAF & af, SAT_Solver * solver)
+{
+	if (k > nodes[node].leaves) k = nodes[node].leaves;
+	uint32_t old_k = nodes[node].outputs.size();
+	if (k <= old_k) return;
+	int32_t left = nodes[node].left;
+	int32_t right = nodes[node].right;
+	extend(left, k, af, solver);
+	extend(right, k, af, solver);
+	for (uint32_t i = old_k; i < k; i++)
+		nodes[node].outputs.push_back(++af.count);
+	const vector<int32_t> & left_outputs = nodes[left].outputs;
+	const vector<int32_t> & right_outputs = nodes[right].outputs;
+	const vector<int32_t> & outputs = nodes[node].outputs;
+	// only the sums in (old_k, k] are new
+	for (uint32_t i = 0; i <= left_outputs.size(); i++) {
+		for (uint32_t j = 0; j <= right_outputs.size(); j++) {
+			if (i+j <= old_k || i+j > k) continue;
+			vector<int32_t> clause;
+			if (i > 0) clause.push_back(-left_outputs[i-1]);
+			if (j > 0) clause.push_back(-right_outputs[j-1]);
+			clause.push_back(outputs[i+j-1]);
+			solver->add_clause(clause);
+		}
+	}
+}
+
+int32_t Totalizer::output(uint32_t k, DynamicAF & af, SAT_Solver * solver)
+{
+	extend(0, k, af, solver);
+	return nodes[0].outputs[k-1];
+}
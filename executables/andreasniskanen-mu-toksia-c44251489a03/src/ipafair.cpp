@@ -43,8 +43,13 @@ void ipafair_del_argument (void * s, int32_t a) { import(s)->del_argument(a); }
 void ipafair_add_attack (void * s, int32_t a, int32_t b) { import(s)->add_attack(a,b); }
 void ipafair_del_attack (void * s, int32_t a, int32_t b) { import(s)->del_attack(a,b); }
 void ipafair_assume (void * s, int32_t a) { import(s)->assume_in(a); }
-int ipafair_solve_cred (void * s) { import(s)->solve(true); return import(s)->get_state(); }
-int ipafair_solve_skept (void * s) { import(s)->solve(false); return import(s)->get_state(); }
+static int status (void * s) { return import(s)->get_state() == UNKNOWN ? 0 : import(s)->get_state(); }
+int ipafair_solve_cred (void * s) { import(s)->solve(true); return status(s); }
+int ipafair_solve_skept (void * s) { import(s)->solve(false); return status(s); }
 int32_t ipafair_val (void * s, int32_t a) { return import(s)->get_val_in(a); }
+void ipafair_set_conflict_budget (void * s, int64_t c) { import(s)->set_conflict_budget(c); }
+void ipafair_set_propagation_budget (void * s, int64_t p) { import(s)->set_propagation_budget(p); }
+void ipafair_set_time_budget (void * s, double t) { import(s)->set_time_budget(t); }
+void ipafair_interrupt (void * s) { import(s)->interrupt(); }
 
 };
\ No newline at end of file
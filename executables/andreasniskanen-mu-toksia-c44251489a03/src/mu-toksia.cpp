@@ -28,6 +28,12 @@
 
 #include "mu-toksia.h"
 #include "Encodings.h"
+#include "LocalSearch.h"
+#include "SmallAF.h"
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_set>
 
 using namespace std;
 
@@ -37,6 +43,20 @@ AFSolver::AFSolver()
 	solver_encoding = UNKNOWN_SEM;
 	current_state = INPUT;
 	buffer_size = INITIAL_BUFFER_SIZE;
+	retired_vars = 0;
+	conflict_budget = -1;
+	propagation_budget = -1;
+	time_budget = -1;
+	interrupted = false;
+	memo_version = 0;
+	grounded_known = false;
+	ideal_known = false;
+	stable_known = false;
+	stable_exists = false;
+	range_cores_sem = UNKNOWN_SEM;
+	knowledge_sem = UNKNOWN_SEM;
+	knowledge_select = 0;
+	refutations_added = 0;
 }
 
 void AFSolver::set_semantics(sigma s)
@@ -112,16 +132,126 @@ void AFSolver::assume_current_structure(SAT_Solver * solver)
 	}
 }
 
-void AFSolver::assume_grounded(SAT_Solver * solver)
+int32_t AFSolver::new_selector()
+{
+	int32_t selector = ++dynamic_af.count;
+	if (!dynamic_af.static_mode) retiring.push_back(selector);
+	return selector;
+}
+
+void AFSolver::retire_selectors()
+{
+	if (dynamic_af.static_mode || !sat_solver || retiring.empty()) return;
+	retired_vars += retiring.size();
+	if (retired_vars > MAX_RETIRED_VARS) {
+		// variables cannot be removed from the solver, so it is rebuilt instead
+		solver_encoding = UNKNOWN_SEM;
+		return;
+	}
+	for (uint32_t i = 0; i < retiring.size(); i++) {
+		vector<int> clause = { retiring[i] };
+		sat_solver->add_clause(clause);
+	}
+	retiring.clear();
+	sat_solver->simplify();
+}
+
+void AFSolver::update_memo()
 {
+	if (memo_version == dynamic_af.version) return;
+	memo_version = dynamic_af.version;
+	if (knowledge_select && !dynamic_af.static_mode) retiring.push_back(knowledge_select);
+	grounded_known = false;
+	ideal_known = false;
+	stable_known = false;
+	grounded.clear();
+	ideal_extension.clear();
+	range_cores.clear();
+	maximal_extensions.clear();
+	refutations.clear();
+	knowledge_select = 0;
+}
+
+void AFSolver::compute_grounded()
+{
+	if (grounded_known) return;
 	SAT_Solver * propagator = new SAT_Solver(dynamic_af.count, 2*dynamic_af.args);
 	Encodings::add_complete(dynamic_af, propagator);
 	assume_current_structure(propagator);
-	vector<int32_t> grounded;
+	grounded.clear();
 	propagator->propagate(grounded);
+	if (propagator) delete propagator;
+	grounded_known = true;
+}
+
+static bool satisfies(const vector<uint8_t> & assignment, const vector<int32_t> & lits)
+{
+	for (uint32_t i = 0; i < lits.size(); i++) {
+		if (assignment[abs(lits[i])-1] != (lits[i] > 0)) return false;
+	}
+	return true;
+}
+
+bool AFSolver::lookup(bool cred)
+{
+	if (!cred && status_assumptions.empty()) return false;
+	if (dynamic_af.sem == ID) {
+		if (!ideal_known) return false;
+		if (satisfies(ideal_extension, status_assumptions))
+			current_state = ACCEPT;
+		else current_state = REJECT;
+		witness = ideal_extension;
+		return true;
+	}
+	if (dynamic_af.sem == ST && stable_known && !stable_exists) {
+		current_state = (cred ? REJECT : ACCEPT);
+		return true;
+	}
+	if (dynamic_af.sem == knowledge_sem) {
+		for (uint32_t i = 0; i < maximal_extensions.size(); i++) {
+			if (satisfies(maximal_extensions[i], status_assumptions) == cred) {
+				current_state = (cred ? ACCEPT : REJECT);
+				witness = maximal_extensions[i];
+				return true;
+			}
+		}
+	}
+	if (dynamic_af.sem == AD || dynamic_af.sem == STG || !grounded_known) return false;
+	// the grounded labelling is contained in every complete extension
+	vector<uint8_t> grounded_assignment(2*dynamic_af.args, 0);
+	vector<uint8_t> grounded_lits(4*dynamic_af.args, 0);
+	for (uint32_t i = 0; i < grounded.size(); i++) {
+		if (grounded[i] > 0) grounded_assignment[grounded[i]-1] = 1;
+		grounded_lits[2*(abs(grounded[i])-1) + (grounded[i] < 0)] = 1;
+	}
+	bool entailed = true;
+	bool refuted = false;
+	for (uint32_t i = 0; i < status_assumptions.size(); i++) {
+		int32_t lit = status_assumptions[i];
+		if (!grounded_lits[2*(abs(lit)-1) + (lit < 0)]) entailed = false;
+		if (grounded_lits[2*(abs(lit)-1) + (lit > 0)]) refuted = true;
+	}
+	if (cred && refuted) {
+		current_state = REJECT;
+		return true;
+	}
+	if (!cred && entailed) {
+		current_state = ACCEPT;
+		return true;
+	}
+	if (dynamic_af.sem == CO && cred == satisfies(grounded_assignment, status_assumptions)) {
+		current_state = (cred ? ACCEPT : REJECT);
+		witness = grounded_assignment;
+		return true;
+	}
+	return false;
+}
+
+void AFSolver::assume_grounded(SAT_Solver * solver)
+{
+	compute_grounded();
 	for (uint32_t i = 0; i < grounded.size(); i++)
 		solver->assume(grounded[i]);
-	if (propagator) delete propagator;
 }
 
 void AFSolver::assume_range(SAT_Solver * solver)
@@ -182,11 +312,44 @@ bool AFSolver::check_extensions(int32_t target, int32_t select)
 	return false;
 }
 
-bool AFSolver::cegar(int32_t target, int32_t select)
+void AFSolver::replay_knowledge()
+{
+	if (knowledge_sem != dynamic_af.sem) {
+		maximal_extensions.clear();
+		refutations.clear();
+		knowledge_select = 0;
+		knowledge_sem = dynamic_af.sem;
+	}
+	if (!knowledge_select) {
+		knowledge_select = ++dynamic_af.count;
+		refutations_added = 0;
+	}
+	for (; refutations_added < refutations.size(); refutations_added++) {
+		vector<int> clause = { knowledge_select };
+		clause.insert(clause.end(), refutations[refutations_added].begin(), refutations[refutations_added].end());
+		sat_solver->add_clause(clause);
+	}
+}
+
+void AFSolver::add_refutation(const vector<int32_t> & refutation)
 {
+	vector<int> clause = { knowledge_select };
+	clause.insert(clause.end(), refutation.begin(), refutation.end());
+	sat_solver->add_clause(clause);
+	refutations.push_back(refutation);
+	refutations_added = refutations.size();
+}
+
+bool AFSolver::cegar(int32_t target, int32_t select, bool learn)
+{
+	// the complement clause of a set with a proper superset refutes every candidate below it;
+	// for range-based semantics the clause of a maximal set would also refute other extensions
+	bool learn_maximal = learn && dynamic_af.sem == PR;
+	vector<int32_t> refutation;
 	while (true) {
 		assume_current_structure(sat_solver);
 		if (select) sat_solver->assume(-select);
+		if (learn) sat_solver->assume(-knowledge_select);
 		if (target) sat_solver->assume(target);
 		bool sat = sat_solver->solve();
 		if (!sat) break;
@@ -194,14 +357,17 @@ bool AFSolver::cegar(int32_t target, int32_t select)
 		while (true) {
 			assume_current_structure(sat_solver);
 			if (select) sat_solver->assume(-select);
+			if (learn) sat_solver->assume(-knowledge_select);
 			if (target) sat_solver->assume(target);
 			vector<int> complement_clause;
 			if (select) complement_clause.push_back(select);
+			refutation.clear();
 			for (uint32_t i = 0; i < objective_vars.size(); i++) {
 				if (sat_solver->get_value(objective_vars[i])) {
 					sat_solver->assume(objective_vars[i]);
 				} else {
 					complement_clause.push_back(objective_vars[i]);
+					refutation.push_back(objective_vars[i]);
 				}
 			}
 			sat_solver->add_clause(complement_clause);
@@ -209,12 +375,16 @@ bool AFSolver::cegar(int32_t target, int32_t select)
 			if (!superset_exists) {
 				if (target) break;
 				extensions.push_back(sat_solver->assignment);
+				if (learn) maximal_extensions.push_back(sat_solver->assignment);
+				if (learn_maximal) add_refutation(refutation);
 				return true;
 			}
+			if (learn) add_refutation(refutation);
 		}
 
 		assume_current_structure(sat_solver);
 		if (select) sat_solver->assume(-select);
+		if (learn) sat_solver->assume(-knowledge_select);
 		for (uint32_t i = 0; i < objective_vars.size(); i++) {
 			if (sat_solver->get_value(objective_vars[i])) {
 				sat_solver->assume(objective_vars[i]);
@@ -222,12 +392,255 @@ bool AFSolver::cegar(int32_t target, int32_t select)
 		}
 		if (!sat_solver->solve()) {
 			extensions.push_back(sat_solver->assignment);
+			if (learn) maximal_extensions.push_back(sat_solver->assignment);
+			if (learn_maximal) add_refutation(refutation);
 			return true;
 		}
+		if (learn) add_refutation(refutation);
 	}
 	return false;
 }
 
+uint32_t AFSolver::get_totalizer(const vector<int32_t> & inputs)
+{
+	auto it = totalizer_index.find(inputs);
+	if (it != totalizer_index.end()) return it->second;
+	totalizers.push_back(Totalizer(inputs));
+	totalizer_index[inputs] = totalizers.size()-1;
+	return totalizers.size()-1;
+}
+
+void AFSolver::relax(const vector<int32_t> & core, vector<int32_t> & soft)
+{
+	unordered_set<int32_t> in_core(core.begin(), core.end());
+	soft.erase(remove_if(soft.begin(), soft.end(), [&](int32_t lit) { return in_core.count(lit); }), soft.end());
+	vector<int32_t> inputs;
+	for (uint32_t i = 0; i < core.size(); i++) {
+		inputs.push_back(-core[i]);
+		auto it = soft_bounds.find(core[i]);
+		if (it == soft_bounds.end()) continue;
+		uint32_t t = it->second.first;
+		uint32_t k = it->second.second+1;
+		soft_bounds.erase(it);
+		if (k <= totalizers[t].size()) {
+			int32_t lit = -totalizers[t].output(k, dynamic_af, sat_solver);
+			soft.push_back(lit);
+			soft_bounds[lit] = make_pair(t, k);
+		}
+	}
+	if (inputs.size() < 2) return;
+	sort(inputs.begin(), inputs.end());
+	uint32_t t = get_totalizer(inputs);
+	int32_t lit = -totalizers[t].output(2, dynamic_af, sat_solver);
+	soft.push_back(lit);
+	soft_bounds[lit] = make_pair(t, 2);
+}
+
+void AFSolver::maximize_range(int32_t target, int32_t select)
+{
+	// OLL over the range variables outside the range of the current model
+	vector<int32_t> hard, soft;
+	for (uint32_t i = 0; i < objective_vars.size(); i++) {
+		if (sat_solver->get_value(objective_vars[i]))
+			hard.push_back(objective_vars[i]);
+		else soft.push_back(objective_vars[i]);
+	}
+	soft_bounds.clear();
+
+	// disjoint cores known for this framework are relaxed without a SAT call
+	if (range_cores_sem != dynamic_af.sem) {
+		range_cores.clear();
+		range_cores_sem = dynamic_af.sem;
+	}
+	vector<uint8_t> available(dynamic_af.args, 0);
+	for (uint32_t i = 0; i < soft.size(); i++)
+		available[soft[i]-dynamic_af.range_var(0)] = 1;
+	for (uint32_t i = 0; i < range_cores.size(); i++) {
+		bool disjoint = true;
+		for (uint32_t j = 0; j < range_cores[i].size() && disjoint; j++)
+			disjoint = available[range_cores[i][j]-dynamic_af.range_var(0)];
+		if (!disjoint) continue;
+		for (uint32_t j = 0; j < range_cores[i].size(); j++)
+			available[range_cores[i][j]-dynamic_af.range_var(0)] = 0;
+		relax(range_cores[i], soft);
+	}
+
+	int32_t first_structure_var = dynamic_af.arg_exists_var(0);
+	int32_t last_structure_var = dynamic_af.att_exists_var(dynamic_af.args-1, dynamic_af.args-1);
+	while (true) {
+		assume_current_structure(sat_solver);
+		if (select) sat_solver->assume(-select);
+		sat_solver->assume(-knowledge_select);
+		if (target) sat_solver->assume(target);
+		for (uint32_t i = 0; i < hard.size(); i++)
+			sat_solver->assume(hard[i]);
+		for (uint32_t i = 0; i < soft.size(); i++)
+			sat_solver->assume(soft[i]);
+		if (sat_solver->solve()) return;
+
+		unordered_set<int32_t> in_soft(soft.begin(), soft.end());
+		vector<int32_t> core;
+		bool reusable = true;
+		for (uint32_t i = 0; i < sat_solver->core.size(); i++) {
+			int32_t lit = sat_solver->core[i];
+			if (in_soft.count(lit)) {
+				core.push_back(lit);
+				if (soft_bounds.count(lit)) reusable = false;
+			} else if (dynamic_af.static_mode || abs(lit) < first_structure_var || abs(lit) > last_structure_var) {
+				reusable = false;
+			}
+		}
+		if (core.empty()) return;
+		if (reusable) {
+			range_cores.push_back(core);
+			sort(range_cores.back().begin(), range_cores.back().end());
+		}
+		relax(core, soft);
+	}
+}
+
+bool AFSolver::cegar_range(int32_t target, int32_t select)
+{
+	while (true) {
+		assume_current_structure(sat_solver);
+		if (select) sat_solver->assume(-select);
+		sat_solver->assume(-knowledge_select);
+		if (target) sat_solver->assume(target);
+		if (!sat_solver->solve()) return false;
+
+		maximize_range(target, select);
+		if (!target) {
+			extensions.push_back(sat_solver->assignment);
+			maximal_extensions.push_back(sat_solver->assignment);
+			return true;
+		}
+
+		vector<uint8_t> candidate = sat_solver->assignment;
+		assume_current_structure(sat_solver);
+		if (select) sat_solver->assume(-select);
+		sat_solver->assume(-knowledge_select);
+		vector<int> complement_clause;
+		if (select) complement_clause.push_back(select);
+		vector<int32_t> refutation;
+		for (uint32_t i = 0; i < objective_vars.size(); i++) {
+			if (sat_solver->get_value(objective_vars[i])) {
+				sat_solver->assume(objective_vars[i]);
+			} else {
+				complement_clause.push_back(objective_vars[i]);
+				refutation.push_back(objective_vars[i]);
+			}
+		}
+		sat_solver->add_clause(complement_clause);
+		if (!sat_solver->solve()) {
+			extensions.push_back(candidate);
+			maximal_extensions.push_back(candidate);
+			witness = candidate;
+			return true;
+		}
+		add_refutation(refutation);
+	}
+}
+
+void AFSolver::seed_heuristics()
+{
+	// arguments attacking many others while being attacked by few are decided first
+	vector<uint32_t> in_degree(dynamic_af.args), out_degree(dynamic_af.args);
+	for (const pair<int32_t,int32_t> & attack : dynamic_af.attacks) {
+		out_degree[attack.first]++;
+		in_degree[attack.second]++;
+	}
+	vector<double> score(dynamic_af.args);
+	double max_score = 0;
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		if (!dynamic_af.arg_exists[i]) continue;
+		score[i] = (out_degree[i]+1.0)/(in_degree[i]+1.0);
+		max_score = max(max_score, score[i]);
+	}
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		if (dynamic_af.arg_exists[i]) sat_solver->set_activity(dynamic_af.accepted_var(i), score[i]/max_score);
+	}
+	// polarities follow the last extension found, or the grounded labelling before any
+	if (!extensions.empty() && extensions.back().size() >= 2*dynamic_af.args) {
+		const vector<uint8_t> & last = extensions.back();
+		for (uint32_t i = 0; i < dynamic_af.args; i++) {
+			if (!dynamic_af.arg_exists[i]) continue;
+			sat_solver->set_phase(last[dynamic_af.accepted_var(i)-1] ? dynamic_af.accepted_var(i) : -dynamic_af.accepted_var(i));
+			sat_solver->set_phase(last[dynamic_af.rejected_var(i)-1] ? dynamic_af.rejected_var(i) : -dynamic_af.rejected_var(i));
+		}
+	} else {
+		for (uint32_t i = 0; i < grounded.size(); i++)
+			sat_solver->set_phase(grounded[i]);
+	}
+}
+
+bool AFSolver::local_search_stable(const vector<int32_t> & lits)
+{
+	if (!dynamic_af.static_mode) dynamic_af.initialize_attackers();
+	vector<int32_t> fixed_lits = lits;
+#if defined(GR_IN_ST)
+	fixed_lits.insert(fixed_lits.end(), grounded.begin(), grounded.end());
+#endif
+	vector<uint8_t> labelling;
+	if (LocalSearch::stable(dynamic_af, fixed_lits, (uint64_t)LS_FLIPS_PER_ARG*dynamic_af.args, labelling)) {
+		stable_known = true;
+		stable_exists = true;
+		extensions.push_back(labelling);
+		witness = labelling;
+		return true;
+	}
+	// the best labelling found guides the first decisions of the SAT solver
+	for (uint32_t i = 0; i < dynamic_af.args && !labelling.empty(); i++) {
+		if (!dynamic_af.arg_exists[i]) continue;
+		sat_solver->set_phase(labelling[dynamic_af.accepted_var(i)-1] ? dynamic_af.accepted_var(i) : -dynamic_af.accepted_var(i));
+		sat_solver->set_phase(labelling[dynamic_af.rejected_var(i)-1] ? dynamic_af.rejected_var(i) : -dynamic_af.rejected_var(i));
+	}
+	return false;
+}
+
+bool AFSolver::preferred_mcs(int32_t target, int32_t select, const vector<int32_t> & lits)
+{
+	// each maximal admissible set found is the complement of a minimal correction
+	// set of the accepted variables, and stays blocked by the knowledge store
+	while (true) {
+		assume_current_structure(sat_solver);
+		sat_solver->assume(-knowledge_select);
+		if (select) sat_solver->assume(-select);
+		sat_solver->assume(target);
+		if (!sat_solver->solve()) return false;
+
+		bool on_target = true;
+		vector<int32_t> refutation;
+		while (true) {
+			assume_current_structure(sat_solver);
+			sat_solver->assume(-knowledge_select);
+			if (select) sat_solver->assume(-select);
+			vector<int> complement_clause;
+			if (select) complement_clause.push_back(select);
+			refutation.clear();
+			for (uint32_t i = 0; i < objective_vars.size(); i++) {
+				if (sat_solver->get_value(objective_vars[i])) {
+					sat_solver->assume(objective_vars[i]);
+				} else {
+					complement_clause.push_back(objective_vars[i]);
+					refutation.push_back(objective_vars[i]);
+				}
+			}
+			sat_solver->add_clause(complement_clause);
+			if (!sat_solver->solve()) break;
+			add_refutation(refutation);
+			on_target = !satisfies(sat_solver->assignment, lits);
+		}
+
+		// only learnt once the extension itself is stored
+		maximal_extensions.push_back(sat_solver->assignment);
+		add_refutation(refutation);
+		if (on_target) {
+			witness = maximal_extensions.back();
+			return true;
+		}
+	}
+}
+
 bool AFSolver::ideal(int32_t target, int32_t select) {
 
 	vector<int> accepted_clause;
@@ -267,6 +680,7 @@ bool AFSolver::ideal(int32_t target, int32_t select) {
 		sat_solver->add_clause(rejected_clause);
 	}
 
+	int32_t cegar_select = (dynamic_af.static_mode ? 0 : new_selector());
 	objective_vars.clear();
 	objective_vars.reserve(dynamic_af.args);
 	for (uint32_t i = 0; i < dynamic_af.args; i++) {
@@ -275,16 +689,177 @@ bool AFSolver::ideal(int32_t target, int32_t select) {
 			objective_vars.push_back(dynamic_af.accepted_var(i));
 		} else {
 			vector<int> clause = { -dynamic_af.accepted_var(i) };
-			if (!dynamic_af.static_mode) clause.push_back(dynamic_af.count+1);
+			if (cegar_select) clause.push_back(cegar_select);
 			sat_solver->add_clause(clause);
 		}
 	}
-	return cegar(target, (dynamic_af.static_mode ? 0 : ++dynamic_af.count));
+	return cegar(target, cegar_select, false);
+}
+
+void AFSolver::ideal_fixpoint(int32_t select)
+{
+	if (!dynamic_af.static_mode) dynamic_af.initialize_attackers();
+	compute_grounded();
+
+	// credulously rejected arguments: attacked by some admissible set
+	vector<uint8_t> rejected(dynamic_af.args, 0);
+	for (uint32_t i = 0; i < grounded.size(); i++) {
+		if (grounded[i] >= dynamic_af.rejected_var(0))
+			rejected[grounded[i]-dynamic_af.rejected_var(0)] = 1;
+	}
+	// an argument can only be rejected by an attacker that is not out in the grounded labelling
+	const vector<uint8_t> out_in_grounded(rejected);
+	vector<uint8_t> unknown(dynamic_af.args, 0);
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		if (!dynamic_af.arg_exists[i] || rejected[i]) continue;
+		for (uint32_t j = 0; j < dynamic_af.attackers[i].size(); j++) {
+			int32_t k = dynamic_af.attackers[i][j];
+			if (!dynamic_af.self_attack[k] && !out_in_grounded[k]) {
+				unknown[i] = 1;
+				break;
+			}
+		}
+	}
+
+	vector<int> rejected_clause;
+	while (true) {
+		rejected_clause.clear();
+		if (select) rejected_clause.push_back(select);
+		for (uint32_t i = 0; i < dynamic_af.args; i++) {
+			if (unknown[i]) rejected_clause.push_back(dynamic_af.rejected_var(i));
+		}
+		if (rejected_clause.size() == (select ? 1 : 0)) break;
+		sat_solver->add_clause(rejected_clause);
+		assume_current_structure(sat_solver);
+		if (select) sat_solver->assume(-select);
+		if (!sat_solver->solve()) break;
+		for (uint32_t i = 0; i < dynamic_af.args; i++) {
+			if (unknown[i] && sat_solver->get_value(dynamic_af.rejected_var(i))) {
+				rejected[i] = 1;
+				unknown[i] = 0;
+			}
+		}
+	}
+
+	// the ideal extension is the largest admissible set of non-rejected arguments
+	vector<vector<int32_t>> targets(dynamic_af.args);
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		for (uint32_t j = 0; j < dynamic_af.attackers[i].size(); j++)
+			targets[dynamic_af.attackers[i][j]].push_back(i);
+	}
+	vector<uint8_t> in(dynamic_af.args, 0);
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		in[i] = dynamic_af.arg_exists[i] && !rejected[i];
+	}
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		if (!dynamic_af.arg_exists[i] || rejected[i]) continue;
+		for (uint32_t j = 0; j < dynamic_af.attackers[i].size(); j++) {
+			int32_t k = dynamic_af.attackers[i][j];
+			if (!rejected[k]) {
+				in[i] = 0;
+				in[k] = 0;
+			}
+		}
+	}
+	vector<uint32_t> defeated(dynamic_af.args, 0);
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		if (!in[i]) continue;
+		for (uint32_t j = 0; j < targets[i].size(); j++)
+			defeated[targets[i][j]]++;
+	}
+	vector<int32_t> queue;
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		if (in[i]) queue.push_back(i);
+	}
+	while (!queue.empty()) {
+		int32_t i = queue.back();
+		queue.pop_back();
+		if (!in[i]) continue;
+		bool defended = true;
+		for (uint32_t j = 0; j < dynamic_af.attackers[i].size(); j++) {
+			if (!defeated[dynamic_af.attackers[i][j]]) {
+				defended = false;
+				break;
+			}
+		}
+		if (defended) continue;
+		in[i] = 0;
+		for (uint32_t j = 0; j < targets[i].size(); j++) {
+			int32_t k = targets[i][j];
+			if (--defeated[k] > 0) continue;
+			for (uint32_t l = 0; l < targets[k].size(); l++) {
+				if (in[targets[k][l]]) queue.push_back(targets[k][l]);
+			}
+		}
+	}
+
+	ideal_extension.assign(2*dynamic_af.args, 0);
+	for (uint32_t i = 0; i < dynamic_af.args; i++) {
+		if (!in[i]) continue;
+		ideal_extension[dynamic_af.accepted_var(i)-1] = 1;
+		for (uint32_t j = 0; j < targets[i].size(); j++)
+			ideal_extension[dynamic_af.rejected_var(targets[i][j])-1] = 1;
+	}
+}
+
+void AFSolver::interrupt()
+{
+	interrupted = true;
+	lock_guard<mutex> lock(solver_mutex);
+	if (sat_solver) sat_solver->interrupt();
+}
+
+void AFSolver::print_stats()
+{
+	lock_guard<mutex> lock(solver_mutex);
+	if (!sat_solver) return;
+	cout << "c clause arena: " << sat_solver->reserved_bytes() << " bytes reserved, huge pages "
+		<< (sat_solver->huge_pages() ? "on" : "off") << "\n";
+}
+
+void AFSolver::set_limits()
+{
+	double seconds = -1;
+	if (time_budget >= 0) {
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - call_start;
+		seconds = max(0.0, time_budget - elapsed.count());
+	}
+	sat_solver->set_limits(conflict_budget, propagation_budget, seconds);
+	if (interrupted) sat_solver->interrupt();
 }
 
 void AFSolver::solve(bool cred)
+{
+	interrupted = false;
+	call_start = chrono::steady_clock::now();
+	try {
+		decide(cred);
+	} catch (const SolveInterrupted &) {
+		current_state = UNKNOWN;
+		status_assumptions.clear();
+		witness.clear();
+	}
+}
+
+bool AFSolver::decide_small(bool cred)
+{
+	if ((!cred && status_assumptions.empty()) || dynamic_af.sem == UNKNOWN_SEM) return false;
+	if (dynamic_af.arg_to_int.size() > SMALL_AF_MAX_ARGS) return false;
+	if (!dynamic_af.static_mode) dynamic_af.initialize_attackers();
+	int result = SmallAF::decide(dynamic_af, status_assumptions, cred, witness);
+	if (result < 0) {
+		witness.clear();
+		return false;
+	}
+	current_state = (result ? ACCEPT : REJECT);
+	status_assumptions.clear();
+	return true;
+}
+
+void AFSolver::decide(bool cred)
 {
 	if (current_state == ERROR) return;
+	witness.clear();
 	if (dynamic_af.static_mode) {
 		dynamic_af.initialize_attackers();
 		dynamic_af.set_var_count();
@@ -297,8 +872,33 @@ void AFSolver::solve(bool cred)
 		extensions.clear();
 	}
 
+	update_memo();
+	if (dynamic_af.sem == CO || dynamic_af.sem == PR || dynamic_af.sem == SST
+#if defined(GR_IN_ST)
+		|| dynamic_af.sem == ST
+#endif
+	) compute_grounded();
+	if (lookup(cred)) {
+		status_assumptions.clear();
+		return;
+	}
+#if defined(SMALL_AF)
+	if (decide_small(cred)) return;
+#endif
+
+	retire_selectors();
+	unique_lock<mutex> lock(solver_mutex);
 	if (dynamic_af.static_mode || dynamic_af.sem != solver_encoding) {
 		if (sat_solver) delete sat_solver;
+		if (!dynamic_af.static_mode) dynamic_af.set_var_count();
+		retiring.clear();
+		retired_vars = 0;
+		totalizers.clear();
+		totalizer_index.clear();
+		knowledge_select = 0;
+#if defined(LAZY_ENCODING)
+		dynamic_af.lazy = dynamic_af.static_mode;
+#endif
 		if (dynamic_af.sem == AD) {
 			sat_solver = new SAT_Solver(dynamic_af.count, 2*dynamic_af.args);
 			Encodings::add_admissible(dynamic_af, sat_solver);
@@ -342,21 +942,52 @@ void AFSolver::solve(bool cred)
 #endif
 			solver_encoding = ID;
 		} else {
+			dynamic_af.lazy = false;
 			current_state = ERROR;
 			return;
 		}
+		if (dynamic_af.lazy) {
+			// the clauses left out of the encoding are added as models violate them
+			SAT_Solver * solver = sat_solver;
+			sat_solver->refine = [this, solver]() { return Encodings::refine(dynamic_af, solver); };
+			dynamic_af.lazy = false;
+		}
+#if defined(SEED_HEURISTICS)
+		seed_heuristics();
+#endif
 	}
+	set_limits();
+	lock.unlock();
 
-	int32_t target = Encodings::add_target(dynamic_af, status_assumptions, sat_solver);
-	status_assumptions.clear();
-	if (!cred) target = -target;
-	int32_t select = (dynamic_af.static_mode ? 0 : ++dynamic_af.count);
+	if (dynamic_af.sem == ID) {
+#if defined(ID_FIXPOINT)
+		ideal_fixpoint(new_selector());
+#else
+		ideal(0, new_selector());
+		ideal_extension = sat_solver->assignment;
+#endif
+		ideal_known = true;
+		lookup(cred);
+		status_assumptions.clear();
+		return;
+	}
+
+	vector<int32_t> target_lits;
+	target_lits.swap(status_assumptions);
+	int32_t target = Encodings::add_target(dynamic_af, target_lits, cred, sat_solver);
+	if (target_lits.size() > 1 && !dynamic_af.static_mode) retiring.push_back(-target);
+	int32_t select = (dynamic_af.static_mode ? 0 : new_selector());
+#if defined(RANGE_MAXSAT)
+	// complement clauses stay retractable so that range cores remain valid
+	if (!select && (dynamic_af.sem == SST || dynamic_af.sem == STG))
+		select = ++dynamic_af.count;
+#endif
 
 	if (dynamic_af.sem == PR || dynamic_af.sem == SST || dynamic_af.sem == STG)
 		set_objective_vars();
 
 	if (extensions.size() > MAX_EXTENSIONS) extensions.erase(extensions.begin());
-	if (dynamic_af.sem != ID && check_extensions(target, select)) {
+	if (check_extensions(target, select)) {
 		current_state = (cred ? ACCEPT : REJECT);
 		return;
 	}
@@ -371,6 +1002,29 @@ void AFSolver::solve(bool cred)
 
 	} else if (dynamic_af.sem == ST) {
 
+#if defined(ST_LOCAL_SEARCH)
+		if (cred && local_search_stable(target_lits)) {
+			current_state = ACCEPT;
+			return;
+		}
+#endif
+		if (!stable_known) {
+			assume_current_structure(sat_solver);
+#if defined(GR_IN_ST)
+			assume_grounded(sat_solver);
+#endif
+			stable_exists = sat_solver->solve();
+			stable_known = true;
+			if (!stable_exists) {
+				current_state = (cred ? REJECT : ACCEPT);
+				return;
+			}
+			extensions.push_back(sat_solver->assignment);
+			if (!target) {
+				current_state = (cred ? ACCEPT : REJECT);
+				return;
+			}
+		}
 		assume_current_structure(sat_solver);
 #if defined(GR_IN_ST)
 		assume_grounded(sat_solver);
@@ -383,7 +1037,14 @@ void AFSolver::solve(bool cred)
 
 	} else if (dynamic_af.sem == PR) {
 
-		if (cegar(target, select))
+		replay_knowledge();
+#if defined(PR_MCS)
+		if (!cred && target) {
+			current_state = (preferred_mcs(target, select, target_lits) ? REJECT : ACCEPT);
+			return;
+		}
+#endif
+		if (cegar(target, select, true))
 			current_state = (cred ? ACCEPT : REJECT);
 		else current_state = (cred ? REJECT : ACCEPT);
 
@@ -406,7 +1067,12 @@ void AFSolver::solve(bool cred)
 		}
 #endif
 
-		if (cegar(target, select))
+		replay_knowledge();
+#if defined(RANGE_MAXSAT)
+		if (cegar_range(target, select))
+#else
+		if (cegar(target, select, true))
+#endif
 			current_state = (cred ? ACCEPT : REJECT);
 		else current_state = (cred ? REJECT : ACCEPT);	
 
@@ -429,13 +1095,12 @@ void AFSolver::solve(bool cred)
 		}
 #endif
 
-		if (cegar(target, select))
-			current_state = (cred ? ACCEPT : REJECT);
-		else current_state = (cred ? REJECT : ACCEPT);
-
-	} else if (dynamic_af.sem == ID) {
-
-		if (ideal(target, select ? select : ++dynamic_af.count))
+		replay_knowledge();
+#if defined(RANGE_MAXSAT)
+		if (cegar_range(target, select))
+#else
+		if (cegar(target, select, true))
+#endif
 			current_state = (cred ? ACCEPT : REJECT);
 		else current_state = (cred ? REJECT : ACCEPT);
 
@@ -451,6 +1116,7 @@ int32_t AFSolver::get_val_in(int32_t arg)
 		return 0;
 	}
 	int32_t arg_index = dynamic_af.arg_to_int.at(arg);
+	if (!witness.empty()) return witness[dynamic_af.accepted_var(arg_index)-1];
 	return sat_solver->get_value(dynamic_af.accepted_var(arg_index));
 }
 
@@ -461,5 +1127,6 @@ int32_t AFSolver::get_val_out(int32_t arg)
 		return 0;
 	}
 	int32_t arg_index = dynamic_af.arg_to_int.at(arg);
+	if (!witness.empty()) return witness[dynamic_af.rejected_var(arg_index)-1];
 	return sat_solver->get_value(dynamic_af.rejected_var(arg_index));
 }
@@ -0,0 +1,92 @@
+/*!
+ * Copyright (c) <2023> <Andreas Niskanen, University of Helsinki>
+ * 
+ * 
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * 
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * 
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// Binary clauses guarded by a selector, like the credulous targets added by
+// Encodings::add_target, must leave the watch lists once the selector is
+// retired by a negative unit, instead of piling up until the solver is rebuilt.
+// The same holds for binaries learnt under the selector, which live in the
+// clause arena and are detached lazily: their watchers must go with them
+// before the arena is compacted.
+
+#include <iostream>
+
+#if defined(SAT_GLUCOSE)
+#include "GlucoseSolver.h"
+
+using namespace std;
+
+#define N_ARGS 50
+#define ROUNDS 2000
+#define TARGET_SIZE 4
+#define LEARNT_SIZE 2
+
+int main()
+{
+	GlucoseSolver solver(N_ARGS, N_ARGS);
+	for (int32_t i = 1; i < N_ARGS; i++)
+		solver.add_clause({ -i, i+1 });
+	int32_t count = N_ARGS;
+	int32_t peak = 0;
+	int32_t stale = 0;
+	for (int32_t round = 0; round < ROUNDS; round++) {
+		int32_t target = ++count;
+		for (int32_t j = 0; j < TARGET_SIZE; j++)
+			solver.add_clause({ -target, (round+j) % N_ARGS + 1 });
+		// deciding a false first leads to a conflict on b, from which (-target a) is learnt
+		for (int32_t j = 0; j < LEARNT_SIZE; j++) {
+			int32_t a = ++count, b = ++count;
+			solver.add_clause({ -target, a, b });
+			solver.add_clause({ -target, a, -b });
+			solver.set_phase(-a);
+			solver.set_activity(a, 1e6);
+		}
+		solver.assume(target);
+		if (!solver.solve()) {
+			cout << "round " << round << ": query unexpectedly unsatisfiable" << endl;
+			return 1;
+		}
+		// the last propagation of the solve call has cleaned the lazily detached watchers
+		stale = max(stale, solver.arena_binary_watches() - 2*solver.arena_binaries());
+		solver.add_clause({ -target });
+		solver.simplify();
+		peak = max(peak, solver.binary_watches());
+	}
+	// the implication chain stays, the retired targets may only linger until the next simplification
+	int32_t chain = 2*(N_ARGS-1);
+	int32_t bound = chain + 2*TARGET_SIZE*ROUNDS/10;
+	cout << "binary watches: " << solver.binary_watches() << ", peak " << peak << ", bound " << bound << endl;
+	cout << "learnt binaries: " << solver.arena_binaries() << ", stale watches " << stale << endl;
+	return peak <= bound && stale == 0 ? 0 : 1;
+}
+#else
+int main()
+{
+	std::cout << "skipped: built without Glucose" << std::endl;
+	return 0;
+}
+#endif
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Compares the circuits built by the compile command of query-ddnnf with the
+extensions of small random AFs enumerated by brute force: count and enum
+after compile, after a save and load, and after dynamic add and del, with
+the plain, -scc and -threads compilers.
+
+Usage: compile_test.py <query-ddnnf> [<rounds>] [<seed>]
+"""
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+def extensions(n, attacks, sem):
+    attackers = [[s for (s, t) in attacks if t == a] for a in range(n)]
+    result = []
+    for mask in range(1 << n):
+        S = [(mask >> a) & 1 for a in range(n)]
+        if any(S[s] and S[t] for (s, t) in attacks):
+            continue
+        attacked = [any(S[s] for s in attackers[a]) for a in range(n)]
+        defended = [all(attacked[s] for s in attackers[a]) for a in range(n)]
+        if any(S[a] and not defended[a] for a in range(n)):
+            continue
+        if sem == "CO" and any(defended[a] and not S[a] for a in range(n)):
+            continue
+        if sem == "ST" and any(not S[a] and not attacked[a] for a in range(n)):
+            continue
+        result.append(tuple(S))
+    return sorted(result)
+
+def run(binary, options, commands):
+    result = subprocess.run([binary] + options, input=commands, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(result.stderr.strip())
+    return [line for line in result.stdout.split("\n") if line and not line.startswith("c ")]
+
+def answers(lines, n):
+    # a count, then the models of an enum projected to the arguments, until the next count
+    groups = []
+    for line in lines:
+        if line == "UNSAT":
+            continue
+        if line.startswith("v "):
+            groups[-1][1].append(tuple(1 if int(x) > 0 else 0 for x in line.split()[1:n+1]))
+        else:
+            groups.append((int(line), []))
+    return [(count, sorted(models)) for (count, models) in groups]
+
+def main():
+    binary = sys.argv[1]
+    rounds = int(sys.argv[2]) if len(sys.argv) > 2 else 60
+    rng = random.Random(int(sys.argv[3]) if len(sys.argv) > 3 else 0)
+    modes = [[], ["-scc"], ["-threads", "2"], ["-scc", "-threads", "2"]]
+    failures = 0
+    with tempfile.TemporaryDirectory() as directory:
+        af_file = os.path.join(directory, "af.txt")
+        saved = os.path.join(directory, "af.bin")
+        for round in range(rounds):
+            n = rng.randint(1, 8)
+            density = rng.random() * 0.4
+            attacks = set((s, t) for s in range(n) for t in range(n) if rng.random() < density)
+            sem = rng.choice(["AD", "CO", "ST"])
+            options = modes[round % len(modes)]
+            with open(af_file, "w") as f:
+                f.write("p af %d\n" % n)
+                for (s, t) in sorted(attacks):
+                    f.write("%d %d\n" % (s+1, t+1))
+
+            # static: the circuit counts and lists the extensions, also when mapped back in
+            commands = "compile %s %s\ncount\nenum\nsave %s\nload %s\ncount\nenum\n" % (af_file, sem, saved, saved)
+            expected = extensions(n, sorted(attacks), sem)
+            got = answers(run(binary, options, commands), n)
+            if got != [(len(expected), expected)] * 2:
+                failures += 1
+                print("static %s %s n=%d attacks=%s: expected %s, got %s" % (" ".join(options), sem, n, sorted(attacks), expected, got))
+
+            # dynamic: attacks compiled with selectors are switched by add and del
+            pairs = [(s, t) for s in range(n) for t in range(n)]
+            dynamic = rng.sample(pairs, min(len(pairs), rng.randint(1, 4)))
+            commands = "compile %s %s %s\ncount\nenum\n" % (af_file, sem, " ".join("%d %d" % (s+1, t+1) for (s, t) in dynamic))
+            current = set(attacks)
+            expected = [extensions(n, sorted(current), sem)]
+            for step in range(4):
+                (s, t) = rng.choice(dynamic)
+                if rng.random() < 0.5:
+                    commands += "add %d %d\ncount\nenum\n" % (s+1, t+1)
+                    current.add((s, t))
+                else:
+                    commands += "del %d %d\ncount\nenum\n" % (s+1, t+1)
+                    current.discard((s, t))
+                expected.append(extensions(n, sorted(current), sem))
+            got = answers(run(binary, options, commands), n)
+            if got != [(len(E), E) for E in expected]:
+                failures += 1
+                print("dynamic %s %s n=%d attacks=%s changing %s: expected %s, got %s" % (" ".join(options), sem, n, sorted(attacks), dynamic, expected, got))
+    print("%d of %d rounds failed" % (failures, rounds))
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
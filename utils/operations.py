@@ -1,4 +1,5 @@
 import os
+import subprocess
 import time
 
 def transform():
@@ -19,22 +20,45 @@ def transform():
     #print("CNF to DDNNF transformation time :"+str(transformation_time))
     return transformation_time
 
-def query():
+REASONERS = {
+    "query-dnnf" : "./executables/query-dnnf",
+    "query-ddnnf" : "./executables/andreasniskanen-mu-toksia-c44251489a03/build/release/bin/query-ddnnf",
+}
+
+def query(reasoner="query-dnnf", timing="wall"):
     '''
     This function executes queries using the d-dnnf reasoner and records the queries total time. 
     It uses a D-DNNF representation stored in a temp file by the d4 compiler.
     The instructions for the queries are stored in a temp file called commands.txt that is filled by the script calling this function. 
-    * The d-dnnf reasoner's output is muted using > /dev/null 2>&1
+    * The d-dnnf reasoner is executables/query-dnnf by default, or query-ddnnf which is built next to mu-toksia with `make q` and reads the same command files
+    * The d-dnnf reasoner's output is muted, except for the "c time" line of query-ddnnf when its own time is used
     
     Arguments:
-        None
+        reasoner : A string, "query-dnnf" (default) or "query-ddnnf", the key of the reasoner in REASONERS.
+        timing : A string, "wall" (default) to time the whole process from outside, or "internal" to use the load and queries time that query-ddnnf reports on its "c time" line.
 
     Returns:
         A float : The recorded queries time.
     '''
+    if(reasoner not in REASONERS):
+        raise ValueError("Unknown d-dnnf reasoner '"+reasoner+"', accepted reasoners : "+",".join(REASONERS))
+    if(timing not in ("wall","internal")):
+        raise ValueError("Unknown timing mode '"+timing+"', accepted modes : wall,internal")
+    if(timing=="internal" and reasoner!="query-ddnnf"):
+        raise ValueError("Only query-ddnnf reports its own time, use the wall timing with "+reasoner)
+    path = REASONERS[reasoner]
+    if(not os.path.isfile(path)):
+        hint = " (run `make q` in mu-toksia's folder to build it)" if reasoner=="query-ddnnf" else ""
+        raise FileNotFoundError("The d-dnnf reasoner "+path+" does not exist"+hint)
+    if(not os.access(path,os.X_OK)):
+        raise PermissionError("The d-dnnf reasoner "+path+" is not executable (chmod +x it)")
     start_time_query=time.time()
-    os.system("./executables/query-dnnf -cmd ./temp_files/commands.txt > /dev/null 2>&1")#execute all queries with the desired software
+    result = subprocess.run([path,"-cmd","./temp_files/commands.txt"],stdout=(subprocess.PIPE if timing=="internal" else subprocess.DEVNULL),stderr=subprocess.DEVNULL,text=True)#execute all queries with the desired software
     query_time = time.time()-start_time_query
+    if(timing=="internal"):
+        reported = [line for line in result.stdout.split("\n") if line.startswith("c time ")]
+        if(not reported):
+            raise RuntimeError(path+" did not report its time on a \"c time\" line")
+        query_time = float(reported[-1].split()[2])
     #print("Queries time :"+str(query_time))
     return query_time
-    
\ No newline at end of file